@@ -96,6 +96,8 @@ if [ -n "$PREFIX" ]; then
   echo "Installed: $PREFIX/bin/dbdSensors"
   echo "Installed: $PREFIX/bin/pd02netCDF"
   echo "Installed: $PREFIX/bin/decompressTWR"
+  echo "Installed: $PREFIX/bin/compressTWR"
+  echo "Installed: $PREFIX/bin/cac2bcc"
 else
   echo ""
   echo "Build and tests succeeded. Binaries are in $SRCDIR/bin/"
@@ -0,0 +1,211 @@
+// Decode throughput benchmarks: the same synthetic record stream decoded
+// through the istream adapters and straight from a ByteCursor.
+
+#include <catch2/catch_all.hpp>
+#include "ByteCursor.H"
+#include "Data.H"
+#include "KnownBytes.H"
+#include "Sensor.H"
+#include "Sensors.H"
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t N_SENSORS = 64;
+constexpr size_t N_RECORDS = 20000;
+// A large glider sensor list where few sensors report in any one cycle
+constexpr size_t N_SPARSE_SENSORS = 1900;
+constexpr size_t N_SPARSE_RECORDS = 4000;
+constexpr unsigned int SPARSE_ONE_IN = 50;
+
+template <class T> void put(std::string& s, const T value, const bool qSwap = false) {
+    std::string bytes(reinterpret_cast<const char*>(&value), sizeof(value));
+    if (qSwap) bytes.assign(bytes.rbegin(), bytes.rend());
+    s += bytes;
+}
+
+size_t width(const size_t i) {
+    static const size_t widths[] = {1, 2, 4, 8};
+    return widths[i % 4];
+}
+
+Sensors makeSensors(const size_t nSensors = N_SENSORS) {
+    Sensors sensors;
+    for (size_t i(0); i < nSensors; ++i) {
+        sensors.insert(Sensor("s: T " + std::to_string(i) + " " + std::to_string(i) + " " +
+                              std::to_string(width(i)) + " sensor_" + std::to_string(i) + " nodim"));
+    }
+    sensors.nToStore(nSensors);
+    return sensors;
+}
+
+// Known bytes, then records where each sensor is absent, repeated, or new with
+// roughly equal odds, then the end-of-data tag. About 1.9 MiB in total.
+// qSwap writes every value byte reversed, as a host of the other order would.
+// A nonzero oneIn instead leaves each sensor idle unless a 1 in oneIn draw
+// makes it repeat or report a new value.
+std::string makeBody(const bool qSwap = false,
+                     const size_t nSensors = N_SENSORS,
+                     const size_t nRecords = N_RECORDS,
+                     const unsigned int oneIn = 0) {
+    std::string s("sa");
+    put<int16_t>(s, 0x1234, qSwap);
+    put<float>(s, 123.456f, qSwap);
+    put<double>(s, 123456789.12345, qSwap);
+
+    std::mt19937 rng(12345);
+    for (size_t r(0); r < nRecords; ++r) {
+        s.push_back('d');
+        std::vector<unsigned int> codes(nSensors + 3);
+        for (size_t i(0); i < nSensors; i += 4) {
+            uint8_t bits(0);
+            for (size_t k(0); (k < 4) && (i + k < nSensors); ++k) {
+                codes[i + k] = oneIn ? ((rng() % oneIn) ? 0 : 1 + rng() % 2) : rng() % 3;
+                bits |= static_cast<uint8_t>(codes[i + k] << (6 - 2 * k));
+            }
+            s.push_back(static_cast<char>(bits));
+        }
+        for (size_t i(0); i < nSensors; ++i) {
+            if (codes[i] != 2) continue;
+            switch (width(i)) {
+                case 1: put<int8_t>(s, static_cast<int8_t>(r), qSwap); break;
+                case 2: put<int16_t>(s, static_cast<int16_t>(r), qSwap); break;
+                case 4: put<float>(s, static_cast<float>(r) / 8, qSwap); break;
+                default: put<double>(s, static_cast<double>(r) * 1.5, qSwap); break;
+            }
+        }
+    }
+    s.push_back('X');
+    return s;
+}
+
+// One value for each of the first four sensors per record, back to back
+std::string makeValues() {
+    std::string s;
+    for (size_t r(0); r < N_RECORDS; ++r) {
+        put<int8_t>(s, static_cast<int8_t>(r));
+        put<int16_t>(s, static_cast<int16_t>(r));
+        put<float>(s, static_cast<float>(r));
+        put<double>(s, static_cast<double>(r));
+    }
+    return s;
+}
+} // namespace
+
+TEST_CASE("Record decode benchmark", "[benchmark][decode]") {
+    const std::string body(makeBody());
+    const Sensors sensors(makeSensors());
+    const char *begin(body.data());
+    const char *end(begin + body.size());
+    // Size hint that preallocates exactly N_RECORDS rows, so the timings are
+    // of decoding rather than of filling oversized columns with NaN
+    const size_t nBytes(N_RECORDS * (N_SENSORS / 4 + 1) / 2);
+
+    BENCHMARK("Data::load from an istream (bulk read, then ByteCursor)") {
+        std::istringstream iss(body, std::ios::binary);
+        const KnownBytes kb(iss);
+        Data data;
+        data.load(iss, kb, sensors, false, nBytes);
+        return data.size();
+    };
+
+    BENCHMARK("Data::load from a ByteCursor") {
+        ByteCursor cursor(begin, end);
+        const KnownBytes kb(cursor);
+        Data data;
+        data.load(cursor, kb, sensors, false, nBytes);
+        return data.size();
+    };
+
+    BENCHMARK("Data::load from a ByteCursor, 4 threads") {
+        ByteCursor cursor(begin, end);
+        const KnownBytes kb(cursor);
+        Data data;
+        data.threads(4);
+        data.load(cursor, kb, sensors, false, nBytes);
+        return data.size();
+    };
+
+    // --sensors with one criteria sensor: about two records in three add
+    // no row, and their values are only decoded if the next row needs them
+    Sensors sparseCriteria(makeSensors());
+    for (size_t i(0); i < N_SENSORS; ++i) {
+        sparseCriteria[i].qCriteria(i == 0);
+    }
+    BENCHMARK("Data::load from a ByteCursor, one criteria sensor") {
+        ByteCursor cursor(begin, end);
+        const KnownBytes kb(cursor);
+        Data data;
+        data.load(cursor, kb, sparseCriteria, false, nBytes);
+        return data.size();
+    };
+
+    const std::string swapped(makeBody(true));
+    BENCHMARK("Data::load from a ByteCursor, other byte order") {
+        ByteCursor cursor(swapped.data(), swapped.data() + swapped.size());
+        const KnownBytes kb(cursor);
+        Data data;
+        data.load(cursor, kb, sensors, false, nBytes);
+        return data.size();
+    };
+}
+
+TEST_CASE("Sparse record decode benchmark", "[benchmark][decode]") {
+    const std::string body(makeBody(false, N_SPARSE_SENSORS, N_SPARSE_RECORDS, SPARSE_ONE_IN));
+    const Sensors sensors(makeSensors(N_SPARSE_SENSORS));
+    const size_t nBytes(N_SPARSE_RECORDS * ((N_SPARSE_SENSORS + 3) / 4 + 1) / 2);
+
+    BENCHMARK("Data::load from a ByteCursor, 1900 sensors, 2% active") {
+        ByteCursor cursor(body.data(), body.data() + body.size());
+        const KnownBytes kb(cursor);
+        Data data;
+        data.load(cursor, kb, sensors, false, nBytes);
+        return data.size();
+    };
+
+    // --sensorOutput keeping every 95th sensor: the values of the other
+    // sensors are skipped over without being visited
+    Sensors some(makeSensors(N_SPARSE_SENSORS));
+    size_t nKept(0);
+    for (size_t i(0); i < N_SPARSE_SENSORS; ++i) {
+        some[i].qKeep((i % 95) == 0);
+        if (some[i].qKeep()) some[i].index(static_cast<int>(nKept++));
+    }
+    some.nToStore(nKept);
+
+    BENCHMARK("Data::load from a ByteCursor, 1900 sensors, 20 kept") {
+        ByteCursor cursor(body.data(), body.data() + body.size());
+        const KnownBytes kb(cursor);
+        Data data;
+        data.load(cursor, kb, some, false, nBytes);
+        return data.size();
+    };
+}
+
+TEST_CASE("Per-value decode benchmark", "[benchmark][decode]") {
+    const std::string values(makeValues());
+    const Sensors sensors(makeSensors());
+    std::istringstream kbStream(makeBody().substr(0, 16), std::ios::binary);
+    const KnownBytes kb(kbStream);
+
+    BENCHMARK("Sensor::read through the istream adapter") {
+        std::istringstream iss(values, std::ios::binary);
+        double sum(0);
+        for (size_t r(0); r < N_RECORDS; ++r) {
+            for (size_t i(0); i < 4; ++i) sum += sensors[i].read(iss, kb);
+        }
+        return sum;
+    };
+
+    BENCHMARK("Sensor::read from a ByteCursor") {
+        ByteCursor cursor(values.data(), values.data() + values.size());
+        double sum(0);
+        for (size_t r(0); r < N_RECORDS; ++r) {
+            for (size_t i(0); i < 4; ++i) sum += sensors[i].read(cursor, kb);
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,183 @@
+// LZ4 benchmarks: a TWR-framed compressed file read back through
+// DecompressTWR's bulk and streambuf paths, against the bare
+// LZ4_decompress_safe calls as the floor, and compressTWR writing it.
+// Also the first pass's header read, through a stream and a HeaderProbe.
+
+#include <catch2/catch_all.hpp>
+#include "Compress.H"
+#include "Decompress.H"
+#include "Header.H"
+#include "HeaderProbe.H"
+#include "lz4.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr size_t N_BYTES = 16 * 1024 * 1024;
+
+// Record-like bytes: slowly varying counters with some noise, which
+// compress about 2:1, a little worse than a glider's data files do
+std::string makePayload() {
+    std::mt19937 rng(20261017);
+    std::string s;
+    s.reserve(N_BYTES);
+    for (uint32_t r(0); s.size() < N_BYTES; ++r) {
+        s.push_back('d');
+        for (int k(0); k < 8; ++k) {
+            const uint32_t v((r >> k) + ((rng() % 8) ? 0 : rng()));
+            s.append(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+    }
+    s.resize(N_BYTES);
+    return s;
+}
+
+void writeFile(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream os(path, std::ios::binary);
+    os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// A flight file's shape: a 14 line header, 1,900 sensor lines, then records
+std::string makeDbd(const std::string& payload) {
+    std::ostringstream oss;
+    oss << "dbd_label: DBD(dinkum_binary_data)file\n"
+        << "encoding_ver: 5\n"
+        << "num_ascii_tags: 14\n"
+        << "all_sensors: 0\n"
+        << "filename: unit_1234-2026-290-0-0\n"
+        << "the8x3_filename: 00300000\n"
+        << "filename_extension: dbd\n"
+        << "filename_label: unit_1234-2026-290-0-0-dbd(00300000)\n"
+        << "mission_name: STOCK.MI\n"
+        << "fileopen_time: Sat_Oct_17_05:00:00_2026\n"
+        << "sensors_per_cycle: 1900\n"
+        << "num_label_lines: 3\n"
+        << "num_segments: 1\n"
+        << "segment_filename_0: unit_1234-2026-290-0-0\n";
+    for (int i(0); i < 1900; ++i) {
+        oss << "s: T " << i << " " << i << " 4 sensor_" << i << " nodim\n";
+    }
+    return oss.str() + payload.substr(0, 4 * 1024 * 1024);
+}
+} // namespace
+
+TEST_CASE("LZ4 block decompression benchmark", "[benchmark][decompress]") {
+    const std::string payload(makePayload());
+    std::vector<char> frames;
+    compressTWR(payload.data(), payload.size(), frames);
+    const std::string path((fs::temp_directory_path() / "dbd2netcdf_benchmark.dcd").string());
+    writeFile(path, frames);
+
+    BENCHMARK("LZ4_decompress_safe per block, from memory") {
+        std::vector<char> out(65536);
+        size_t total(0);
+        for (size_t i(0); i + 2 <= frames.size();) {
+            const size_t n((static_cast<unsigned char>(frames[i]) << 8) |
+                           static_cast<unsigned char>(frames[i + 1]));
+            const int j(LZ4_decompress_safe(frames.data() + i + 2, out.data(),
+                                            static_cast<int>(n), static_cast<int>(out.size())));
+            total += static_cast<size_t>(j);
+            i += 2 + n;
+        }
+        return total;
+    };
+
+    BENCHMARK("DecompressTWR::readRemaining (Data::load)") {
+        DecompressTWR is(path, true);
+        std::vector<char> buffer;
+        return is.readRemaining(buffer);
+    };
+
+    BENCHMARK("DecompressTWR::readRemaining on 4 threads") {
+        DecompressTWR is(path, true);
+        std::vector<char> buffer;
+        return is.readRemaining(buffer, 4);
+    };
+
+    BENCHMARK("DecompressTWR, istream::read of 1 MiB at a time (decompressTWR)") {
+        DecompressTWR is(path, true);
+        std::vector<char> buffer(1024 * 1024);
+        size_t total(0);
+        while (is.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || is.gcount()) {
+            total += static_cast<size_t>(is.gcount());
+        }
+        return total;
+    };
+
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
+TEST_CASE("LZ4 block compression benchmark", "[benchmark][decompress][compress]") {
+    const std::string payload(makePayload());
+    const std::string path((fs::temp_directory_path() / "dbd2netcdf_benchmark_rt.dcd").string());
+
+    BENCHMARK("compressTWR (compressTWR)") {
+        std::vector<char> frames;
+        return compressTWR(payload.data(), payload.size(), frames);
+    };
+
+    BENCHMARK("compressTWR on 4 threads") {
+        std::vector<char> frames;
+        return compressTWR(payload.data(), payload.size(), frames, 4);
+    };
+
+    // compressTWR's file, then decompressTWR's reading of it
+    BENCHMARK("Round trip: compressTWR, write, DecompressTWR::readRemaining") {
+        std::vector<char> frames;
+        compressTWR(payload.data(), payload.size(), frames);
+        writeFile(path, frames);
+        DecompressTWR is(path, true);
+        std::vector<char> buffer;
+        return is.readRemaining(buffer);
+    };
+
+    BENCHMARK("Round trip on 4 threads") {
+        std::vector<char> frames;
+        compressTWR(payload.data(), payload.size(), frames, 4);
+        writeFile(path, frames);
+        DecompressTWR is(path, true);
+        std::vector<char> buffer;
+        return is.readRemaining(buffer, 4);
+    };
+
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
+TEST_CASE("Header probe benchmark", "[benchmark][decompress][header]") {
+    const std::string dbd(makeDbd(makePayload()));
+    const std::string plain((fs::temp_directory_path() / "dbd2netcdf_benchmark_probe.dbd").string());
+    const std::string packed((fs::temp_directory_path() / "dbd2netcdf_benchmark_probe.dcd").string());
+    writeFile(plain, std::vector<char>(dbd.begin(), dbd.end()));
+    std::vector<char> frames;
+    compressTWR(dbd.data(), dbd.size(), frames);
+    writeFile(packed, frames);
+
+    for (const std::string& path : {plain, packed}) {
+        const bool qPacked(qCompressed(path));
+        const std::string which(qPacked ? ", compressed" : ", uncompressed");
+
+        BENCHMARK("DecompressTWR and Header (first pass before)" + which) {
+            DecompressTWR is(path, qPacked);
+            const Header hdr(is, path.c_str());
+            return hdr.crc().size() + static_cast<size_t>(is.tellg());
+        };
+
+        BENCHMARK("HeaderProbe" + which) {
+            const HeaderProbe probe(path, qPacked);
+            return probe.header().crc().size() + probe.sensorOffset();
+        };
+    }
+
+    std::error_code ec;
+    fs::remove(plain, ec);
+    fs::remove(packed, ec);
+}
@@ -5,10 +5,15 @@
 #include <catch2/catch_all.hpp>
 #include "Sensor.H"
 #include "Sensors.H"
+#include "SensorsMap.H"
 #include "Header.H"
 #include "MyException.H"
+#include "SensorCache.H"
+#include <filesystem>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Sample sensor lines for benchmarking
@@ -148,3 +153,143 @@ TEST_CASE("Sensors container operations benchmark", "[benchmark][sensors]") {
         return s.size();
     };
 }
+
+TEST_CASE("Sensor cache load benchmark", "[benchmark][sensors][cache]") {
+    // A flight file sized sensor list, in a directory holding only the text
+    // cache and in one holding only the binary cache
+    namespace fs = std::filesystem;
+    const fs::path root(fs::temp_directory_path() / "dbd2netcdf_bench_cache");
+    const fs::path textDir(root / "text");
+    const fs::path binaryDir(root / "binary");
+    fs::create_directories(textDir);
+    fs::create_directories(binaryDir);
+
+    std::vector<Sensor> list;
+    for (int i = 0; i < 1900; ++i) {
+        std::ostringstream oss;
+        oss << "s: T " << i << " " << i << " " << (i % 3 ? 4 : 8)
+            << " sensor_" << i << "_name " << (i % 5 ? "nodim" : "m");
+        list.emplace_back(oss.str());
+    }
+    {
+        std::ofstream os((textDir / "abcd1234.cac").string());
+        for (const auto& sensor : list) sensor.dump(os);
+        const std::vector<char> bytes(SensorCache::encode("abcd1234", list));
+        std::ofstream bs((binaryDir / "abcd1234.bcc").string(), std::ios::binary);
+        bs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::istringstream is("num_ascii_tags: 3\nsensor_list_factored: 1\nsensor_list_crc: ABCD1234\n");
+    const Header hdr(is, "bench.sbd");
+
+    BENCHMARK("Load 1900 sensors from the text .cac") {
+        Sensors sensors;
+        sensors.load(textDir.string(), hdr);
+        return sensors.size();
+    };
+
+    BENCHMARK("Load 1900 sensors from the binary .bcc") {
+        Sensors sensors;
+        sensors.load(binaryDir.string(), hdr);
+        return sensors.size();
+    };
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+}
+
+TEST_CASE("SensorsMap fleet benchmark", "[benchmark][sensorsmap]") {
+    // 200 sensor lists of 1,900 sensors drawn from 2,400 names, as a
+    // fleet-wide run sees them, with keep and criteria lists
+    const int nLists = 200;
+    const int nSensors = 1900;
+    const int nNames = 2400;
+    SensorsMap smap;
+    for (int k = 0; k < nLists; ++k) {
+        std::ostringstream hs;
+        hs << "num_ascii_tags: 4\ntotal_num_sensors: " << nSensors
+           << "\nsensor_list_factored: 0\nsensor_list_crc: " << std::hex << (0x10000 + k) << "\n";
+        std::istringstream his(hs.str());
+        const Header hdr(his, "fleet.dbd");
+
+        std::ostringstream ss;
+        for (int i = 0; i < nSensors; ++i) {
+            const int name = (i + 7 * k) % nNames;
+            ss << "s: T " << i << " " << i << " 4 sensor_" << name << "_name nodim\n";
+        }
+        std::istringstream sis(ss.str());
+        smap.insert(sis, hdr, false);
+    }
+
+    Sensors::tNames keep, criteria;
+    for (int i = 0; i < nNames; i += 3) keep.insert("sensor_" + std::to_string(i) + "_name");
+    for (int i = 0; i < nNames; i += 300) criteria.insert("sensor_" + std::to_string(i) + "_name");
+
+    BENCHMARK("qKeep and qCriteria over 200 sensor lists") {
+        smap.qKeep(keep);
+        smap.qCriteria(criteria);
+        return smap.allSensors().size();
+    };
+
+    BENCHMARK("setUpForData over 200 sensor lists") {
+        smap.setUpForData();
+        return smap.allSensors().size();
+    };
+}
+
+TEST_CASE("SensorsMap contention benchmark", "[benchmark][sensorsmap][threads]") {
+    // Decoder threads looking up 200 known sensor lists, alone and while
+    // another thread inserts new ones
+    const int nLists = 200;
+    const int nFinds = 20000;
+    auto header = [](const int k, const int nSensors) {
+        std::ostringstream hs;
+        hs << "num_ascii_tags: 4\ntotal_num_sensors: " << nSensors
+           << "\nsensor_list_factored: 0\nsensor_list_crc: " << std::hex << (0x20000 + k) << "\n";
+        std::istringstream his(hs.str());
+        return Header(his, "contention.dbd");
+    };
+
+    SensorsMap smap;
+    std::vector<Header> headers;
+    for (int k = 0; k < nLists; ++k) {
+        headers.push_back(header(k, 10));
+        std::ostringstream ss;
+        for (int i = 0; i < 10; ++i) ss << "s: T " << i << " " << i << " 4 sensor_" << i << " nodim\n";
+        std::istringstream sis(ss.str());
+        smap.insert(sis, headers.back(), false);
+    }
+
+    auto finds = [&smap, &headers](const int nThreads) {
+        std::vector<size_t> sums(nThreads, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nThreads; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < nFinds / nThreads; ++i) {
+                    sums[t] += smap.find(headers[(i * 7 + t) % nLists]).size();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        size_t sum = 0;
+        for (const size_t x : sums) sum += x;
+        return sum;
+    };
+
+    BENCHMARK("20,000 finds on 1 thread") { return finds(1); };
+    BENCHMARK("20,000 finds on 4 threads") { return finds(4); };
+    BENCHMARK("20,000 finds on 16 threads") { return finds(16); };
+
+    int next = nLists;
+    BENCHMARK("20,000 finds on 4 threads while 50 sensor lists are inserted") {
+        std::thread writer([&smap, &header, &next] {
+            for (int k = 0; k < 50; ++k, ++next) {
+                std::istringstream sis("s: T 0 0 4 m_depth m\n");
+                smap.insert(sis, header(next, 1), false);
+            }
+        });
+        const size_t sum = finds(4);
+        writer.join();
+        return sum;
+    };
+}
@@ -0,0 +1,113 @@
+// NetCDF write throughput: a column of 1,000,000 values written through
+// NetCDF::putVara in its variable's own type, as dbd2netCDF writes Data
+// columns, and as doubles, which the library converts value by value. Then
+// many short files' worth of compressed records, written as they arrive and
+// through putVaraBuffered, which holds them until a chunk is complete.
+
+#include <catch2/catch_all.hpp>
+#include "MyNetCDF.H"
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t N_ROWS = 1000000;
+constexpr size_t BLOCK_ROWS = 4096; // As Column hands blocks to putVara
+
+std::string benchPath(const std::string& stem) {
+    return (std::filesystem::temp_directory_path() / ("dbd2netcdf_bench_" + stem + ".nc")).string();
+}
+
+// Write values, block by block, to a fresh uncompressed file
+template <class T>
+size_t writeColumn(const std::string& fn, const nc_type idType, const std::vector<T>& values) {
+    {
+        NetCDF nc(fn, false);
+        nc.compressionLevel(0); // Time the write path, not zlib
+        const int dim = nc.maybeCreateDim("i");
+        const int var = nc.createVar("x", idType, dim, "m");
+        for (size_t k = 0; k < values.size(); k += BLOCK_ROWS) {
+            nc.putVara(var, k, std::min(BLOCK_ROWS, values.size() - k), values.data() + k);
+        }
+    }
+    const size_t n = std::filesystem::file_size(fn);
+    std::filesystem::remove(fn);
+    return n;
+}
+
+template <class T>
+std::vector<T> makeValues(const double lo, const double hi) {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<T> values(N_ROWS);
+    for (T& value : values) value = static_cast<T>(dist(rng));
+    return values;
+}
+
+template <class T>
+void benchmarkType(const std::string& name, const nc_type idType, const double lo, const double hi) {
+    const std::vector<T> values(makeValues<T>(lo, hi));
+    const std::vector<double> widened(values.begin(), values.end());
+    const std::string fn(benchPath(name));
+
+    BENCHMARK(name + " column written as " + name) {
+        return writeColumn(fn, idType, values);
+    };
+
+    BENCHMARK(name + " column written as double") {
+        return writeColumn(fn, idType, widened);
+    };
+}
+
+constexpr size_t N_FILES = 400;        // A fleet of short .sbd files
+constexpr size_t ROWS_PER_FILE = 250;  // 20 files per 5000 row chunk
+constexpr size_t N_VARS = 40;
+
+// Write N_VARS compressed float columns a file's records at a time
+size_t writeFiles(const std::string& fn, const std::vector<float>& values, const bool qBuffered) {
+    {
+        NetCDF nc(fn, false);
+        const int dim = nc.maybeCreateDim("i");
+        std::vector<int> vars;
+        for (size_t j = 0; j < N_VARS; ++j) {
+            vars.push_back(nc.createVar("x" + std::to_string(j), NC_FLOAT, dim, "m"));
+        }
+        for (size_t k = 0; k < values.size(); k += ROWS_PER_FILE) {
+            for (const int var : vars) {
+                if (qBuffered) {
+                    nc.putVaraBuffered(var, k, ROWS_PER_FILE, values.data() + k);
+                } else {
+                    nc.putVara(var, k, ROWS_PER_FILE, values.data() + k);
+                }
+            }
+        }
+    }
+    const size_t n = std::filesystem::file_size(fn);
+    std::filesystem::remove(fn);
+    return n;
+}
+} // namespace
+
+TEST_CASE("NetCDF putVara write benchmark", "[benchmark][netcdf]") {
+    benchmarkType<int8_t>("int8", NC_BYTE, -100, 100);
+    benchmarkType<int16_t>("int16", NC_SHORT, -30000, 30000);
+    benchmarkType<float>("float", NC_FLOAT, -1000, 1000);
+}
+
+TEST_CASE("NetCDF chunk-aligned write benchmark", "[benchmark][netcdf]") {
+    std::mt19937 rng(12345);
+    std::normal_distribution<float> dist(0, 1);
+    std::vector<float> values(N_FILES * ROWS_PER_FILE);
+    for (float& value : values) value = dist(rng);
+    const std::string fn(benchPath("files"));
+
+    BENCHMARK("400 files written as they arrive") {
+        return writeFiles(fn, values, false);
+    };
+
+    BENCHMARK("400 files written a chunk at a time") {
+        return writeFiles(fn, values, true);
+    };
+}
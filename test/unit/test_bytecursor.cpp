@@ -0,0 +1,319 @@
+// Unit tests for ByteCursor and the decode path written against it: the
+// KnownBytes, Sensor, and Data cursor entry points, and the bulk read of
+// compressed input that feeds them.
+
+#include <catch2/catch_test_macros.hpp>
+#include "ByteCursor.H"
+#include "Data.H"
+#include "Decompress.H"
+#include "KnownBytes.H"
+#include "MyException.H"
+#include "Sensor.H"
+#include "Sensors.H"
+#include "lz4.h"
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string tempPath(const std::string& stem, const std::string& ext) {
+    std::mt19937 rng{std::random_device{}()};
+    return (fs::temp_directory_path() /
+            ("dbd2netcdf_test_" + stem + "_" + std::to_string(rng()) + ext)).string();
+}
+
+struct ScopedPath {
+    std::string path;
+    explicit ScopedPath(std::string p) : path(std::move(p)) {}
+    ~ScopedPath() {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    ScopedPath(const ScopedPath&) = delete;
+    ScopedPath& operator=(const ScopedPath&) = delete;
+};
+
+template <class T> void put(std::string& s, const T value) {
+    s.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::string knownBytes() {
+    std::string s("sa");
+    put<int16_t>(s, 0x1234);
+    put<float>(s, 123.456f);
+    put<double>(s, 123456789.12345);
+    return s;
+}
+
+// Known bytes, then records for three sensors of widths 2, 4, 8 where every
+// third record repeats the previous values, then the end-of-data tag.
+std::string makeBody(const size_t nRecords) {
+    std::string s(knownBytes());
+    for (size_t r(0); r < nRecords; ++r) {
+        s.push_back('d');
+        if (r % 3 == 2) {
+            s.push_back(static_cast<char>(0x54)); // 01 01 01 00: all repeat
+            continue;
+        }
+        s.push_back(static_cast<char>(0xA8)); // 10 10 10 00: all new
+        put<int16_t>(s, static_cast<int16_t>(r));
+        put<float>(s, static_cast<float>(r) / 2);
+        put<double>(s, static_cast<double>(r) * 1.0e3);
+    }
+    s.push_back('X');
+    return s;
+}
+
+Sensors makeSensors() {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 2 s16 nodim"));
+    sensors.insert(Sensor("s: T 1 1 4 s32 nodim"));
+    sensors.insert(Sensor("s: T 2 2 8 s64 nodim"));
+    sensors.nToStore(3);
+    return sensors;
+}
+
+// TWR framing: each LZ4 block is preceded by its big-endian 2-byte length
+void writeCompressed(const std::string& path, const std::string& payload) {
+    std::ofstream os(path, std::ios::binary);
+    constexpr size_t BLOCK = 4096;
+    for (size_t i(0); i < payload.size(); i += BLOCK) {
+        const std::string chunk(payload.substr(i, BLOCK));
+        std::vector<char> compressed(static_cast<size_t>(
+            LZ4_compressBound(static_cast<int>(chunk.size()))));
+        const int n = LZ4_compress_default(chunk.data(), compressed.data(),
+                                           static_cast<int>(chunk.size()),
+                                           static_cast<int>(compressed.size()));
+        REQUIRE(n > 0);
+        const unsigned char hdr[2] = {
+            static_cast<unsigned char>((n >> 8) & 0xff),
+            static_cast<unsigned char>(n & 0xff)};
+        os.write(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+        os.write(compressed.data(), n);
+    }
+}
+
+void requireSame(const Data& a, const Data& b) {
+    REQUIRE(a.size() == b.size());
+    REQUIRE(a.nColumns() == b.nColumns());
+    for (size_t j(0); j < a.nColumns(); ++j) {
+        for (size_t i(0); i < a.size(); ++i) {
+            const double x(a(i, j));
+            const double y(b(i, j));
+            CHECK(((std::isnan(x) && std::isnan(y)) || (x == y)));
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("ByteCursor walks and bounds-checks a byte range", "[bytecursor]") {
+    const std::string bytes("abcdef");
+    ByteCursor cursor(bytes.data(), bytes.data() + bytes.size(), 100);
+
+    int8_t c;
+    REQUIRE(cursor.get(c));
+    CHECK(c == 'a');
+    CHECK(cursor.offset() == 101);
+
+    const char *p(cursor.take(3));
+    REQUIRE(p != nullptr);
+    CHECK(std::string(p, 3) == "bcd");
+    CHECK(cursor.remaining() == 2);
+    CHECK(cursor.consumed() == 4);
+
+    SECTION("a short take consumes the rest, like a short istream read") {
+        CHECK(cursor.take(3) == nullptr);
+        CHECK(cursor.empty());
+        CHECK_FALSE(cursor.get(c));
+        CHECK(cursor.offset() == 106);
+    }
+
+    SECTION("an exact take reaches the end") {
+        REQUIRE(cursor.take(2) != nullptr);
+        CHECK(cursor.empty());
+    }
+}
+
+TEST_CASE("KnownBytes and Sensor read from a ByteCursor", "[bytecursor][knownbytes]") {
+    std::string bytes(knownBytes());
+    put<int16_t>(bytes, -1234);
+    put<double>(bytes, 2.5);
+    ByteCursor cursor(bytes.data(), bytes.data() + bytes.size());
+
+    const KnownBytes kb(cursor);
+    CHECK(cursor.consumed() == kb.length());
+    CHECK(Sensor("s: T 0 0 2 s16 nodim").read(cursor, kb) == -1234);
+    CHECK(Sensor("s: T 0 0 8 s64 nodim").read(cursor, kb) == 2.5);
+    CHECK(cursor.empty());
+
+    SECTION("reading past the end throws") {
+        CHECK_THROWS_AS(kb.read32(cursor), MyException);
+    }
+
+    SECTION("a truncated known bytes block throws") {
+        ByteCursor shortCursor(bytes.data(), bytes.data() + 10);
+        CHECK_THROWS_AS(KnownBytes(shortCursor), MyException);
+    }
+}
+
+TEST_CASE("Data decodes the same records from a cursor and an istream",
+          "[bytecursor][data]") {
+    const std::string body(makeBody(200));
+    const Sensors sensors(makeSensors());
+
+    std::istringstream iss(body, std::ios::binary);
+    const KnownBytes kbStream(iss);
+    Data viaStream;
+    viaStream.load(iss, kbStream, sensors, false, body.size());
+
+    ByteCursor cursor(body.data(), body.data() + body.size());
+    const KnownBytes kb(cursor);
+    Data viaCursor;
+    viaCursor.load(cursor, kb, sensors, false, body.size());
+
+    REQUIRE(viaCursor.size() == 200);
+    requireSame(viaStream, viaCursor);
+    CHECK(viaCursor(2, 2) == 1.0e3); // Record 2 repeats record 1
+    CHECK(cursor.empty()); // Stopped just past the 'X' tag
+}
+
+TEST_CASE("Compressed input is decompressed into one buffer for the cursor",
+          "[bytecursor][decompress]") {
+    const std::string body(makeBody(5000)); // Spans several LZ4 blocks
+    ScopedPath file(tempPath("cursor", ".scd"));
+    writeCompressed(file.path, body);
+
+    SECTION("readRemaining returns every decompressed byte") {
+        DecompressTWR is(file.path, true);
+        std::string head(4, '\0');
+        REQUIRE(is.read(&head[0], 4));
+        std::vector<char> rest;
+        CHECK(is.readRemaining(rest) == body.size() - 4);
+        CHECK(head + std::string(rest.begin(), rest.end()) == body);
+        CHECK(is.tellg() == std::streampos(static_cast<std::streamoff>(body.size())));
+    }
+
+    SECTION("decoded records match the uncompressed bytes") {
+        DecompressTWR is(file.path, true);
+        const KnownBytes kbCompressed(is);
+        Data viaCompressed;
+        viaCompressed.load(is, kbCompressed, makeSensors(), false, fs::file_size(file.path));
+
+        std::istringstream iss(body, std::ios::binary);
+        const KnownBytes kb(iss);
+        Data viaStream;
+        viaStream.load(iss, kb, makeSensors(), false, body.size());
+
+        REQUIRE(viaCompressed.size() == 5000);
+        requireSame(viaStream, viaCompressed);
+    }
+}
+
+TEST_CASE("Compressed input decompresses the same on several threads",
+          "[bytecursor][decompress]") {
+    const std::string body(makeBody(20000)); // About 60 LZ4 blocks
+    ScopedPath file(tempPath("threads", ".scd"));
+    writeCompressed(file.path, body);
+
+    SECTION("every block, in order") {
+        for (const size_t nThreads : {1, 2, 4, 7}) {
+            DecompressTWR is(file.path, true);
+            std::string head(3, '\0');
+            REQUIRE(is.read(&head[0], 3));
+            std::vector<char> rest;
+            CHECK(is.readRemaining(rest, nThreads) == body.size() - 3);
+            CHECK(head + std::string(rest.begin(), rest.end()) == body);
+            CHECK(is.tellg() == std::streampos(static_cast<std::streamoff>(body.size())));
+
+            // Every block was indexed on the way, so seeking back finds it
+            std::string again(16, '\0');
+            REQUIRE(is.seekg(123456));
+            REQUIRE(is.read(&again[0], 16));
+            CHECK(again == body.substr(123456, 16));
+        }
+    }
+
+    SECTION("blocks of varying size, which are left to the serial reader") {
+        std::ofstream os(file.path, std::ios::binary);
+        for (size_t i(0), k(0); i < body.size(); ++k) {
+            const std::string chunk(body.substr(i, (k % 2) ? 3000 : 5000));
+            i += chunk.size();
+            std::vector<char> compressed(static_cast<size_t>(
+                LZ4_compressBound(static_cast<int>(chunk.size()))));
+            const int n = LZ4_compress_default(chunk.data(), compressed.data(),
+                                               static_cast<int>(chunk.size()),
+                                               static_cast<int>(compressed.size()));
+            REQUIRE(n > 0);
+            os.put(static_cast<char>((n >> 8) & 0xff));
+            os.put(static_cast<char>(n & 0xff));
+            os.write(compressed.data(), n);
+        }
+        os.close();
+
+        DecompressTWR is(file.path, true);
+        std::vector<char> all;
+        CHECK(is.readRemaining(all, 4) == body.size());
+        CHECK(std::string(all.begin(), all.end()) == body);
+    }
+
+    SECTION("up to a corrupt block, as the serial reader stops") {
+        {
+            std::ofstream os(file.path, std::ios::binary | std::ios::app);
+            // A length header promising 8 bytes of LZ4 data that is not valid LZ4
+            os.write("\x00\x08\xff\xff\xff\xff\xff\xff\xff\xff", 10);
+            os.write("\x00\x06\x50hello", 8); // A good block after it
+        }
+        for (const size_t nThreads : {1, 4}) {
+            DecompressTWR is(file.path, true);
+            std::vector<char> all;
+            CHECK(is.readRemaining(all, nThreads) == body.size());
+            CHECK(std::string(all.begin(), all.end()) == body);
+        }
+    }
+}
+
+TEST_CASE("Compressed input is seekable", "[bytecursor][decompress]") {
+    const std::string body(makeBody(5000)); // Spans several LZ4 blocks
+    ScopedPath file(tempPath("seek", ".scd"));
+    writeCompressed(file.path, body);
+    const std::streamoff size(static_cast<std::streamoff>(body.size()));
+
+    DecompressTWR is(file.path, true);
+    auto readAt = [&](const std::streamoff pos, const size_t n) {
+        std::string got(n, '\0');
+        REQUIRE(is.seekg(pos));
+        REQUIRE(is.read(&got[0], static_cast<std::streamsize>(n)));
+        CHECK(is.tellg() == std::streampos(pos + static_cast<std::streamoff>(n)));
+        return got;
+    };
+
+    CHECK(readAt(20000, 16) == body.substr(20000, 16)); // Forward, blocks unread
+    CHECK(readAt(5, 16) == body.substr(5, 16));         // Back to an indexed block
+    CHECK(readAt(4090, 12) == body.substr(4090, 12));   // Across a block boundary
+    CHECK(readAt(20004, 4) == body.substr(20004, 4));
+
+    REQUIRE(is.seekg(-10, std::ios::end));
+    CHECK(is.tellg() == std::streampos(size - 10));
+    REQUIRE(is.seekg(3, std::ios::cur));
+    CHECK(is.tellg() == std::streampos(size - 7));
+
+    REQUIRE(is.seekg(size)); // The end itself is a position
+    CHECK(is.get() == std::char_traits<char>::eof());
+    is.clear();
+
+    REQUIRE(is.seekg(100));
+    CHECK_FALSE(is.seekg(size + 1)); // Past the end fails, and stays put
+    is.clear();
+    CHECK(is.tellg() == std::streampos(100));
+
+    std::vector<char> rest; // The bulk read, then back to the start
+    CHECK(is.readRemaining(rest) == body.size() - 100);
+    CHECK(readAt(0, 8) == body.substr(0, 8));
+}
@@ -0,0 +1,131 @@
+// Unit tests for compressTWR, the writer of the TWR LZ4 framing that
+// DecompressTWR reads back.
+
+#include <catch2/catch_test_macros.hpp>
+#include "Compress.H"
+#include "Decompress.H"
+#include "lz4.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string tempPath(const std::string& stem) {
+    std::mt19937 rng{std::random_device{}()};
+    return (fs::temp_directory_path() /
+            ("dbd2netcdf_test_" + stem + "_" + std::to_string(rng()) + ".dcd")).string();
+}
+
+struct ScopedFile {
+    std::string path;
+    ScopedFile(std::string p, const std::vector<char>& contents) : path(std::move(p)) {
+        std::ofstream os(path, std::ios::binary);
+        os.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+    ~ScopedFile() {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    ScopedFile(const ScopedFile&) = delete;
+    ScopedFile& operator=(const ScopedFile&) = delete;
+};
+
+// Counters with some noise, which LZ4 can shrink but not to nothing
+std::string makePayload(const size_t n) {
+    std::mt19937 rng(20261017);
+    std::string s;
+    s.reserve(n + 4);
+    for (uint32_t r(0); s.size() < n; ++r) {
+        const uint32_t v(r + ((rng() % 4) ? 0 : rng()));
+        s.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    s.resize(n);
+    return s;
+}
+
+// Each frame's decompressed size, checking the framing on the way
+std::vector<int> blockSizes(const std::vector<char>& frames) {
+    std::vector<int> sizes;
+    std::vector<char> block(65536);
+    for (size_t i(0); i < frames.size();) {
+        REQUIRE(i + 2 <= frames.size());
+        const size_t n((static_cast<size_t>(static_cast<unsigned char>(frames[i])) << 8) |
+                       static_cast<unsigned char>(frames[i + 1]));
+        REQUIRE(i + 2 + n <= frames.size());
+        sizes.push_back(LZ4_decompress_safe(frames.data() + i + 2, block.data(),
+                                            static_cast<int>(n), static_cast<int>(block.size())));
+        i += 2 + n;
+    }
+    return sizes;
+}
+} // namespace
+
+TEST_CASE("compressTWR writes blocks as TWR does", "[compress]") {
+    for (const size_t n : {size_t(0), size_t(1), TWR_BLOCK_SIZE - 1, TWR_BLOCK_SIZE,
+                           TWR_BLOCK_SIZE + 1, 40 * TWR_BLOCK_SIZE + 123}) {
+        const std::string payload(makePayload(n));
+        std::vector<char> frames;
+        const size_t nFrames(compressTWR(payload.data(), payload.size(), frames));
+        CHECK(nFrames == frames.size());
+
+        const std::vector<int> sizes(blockSizes(frames));
+        REQUIRE(sizes.size() == (n + TWR_BLOCK_SIZE - 1) / TWR_BLOCK_SIZE);
+        for (size_t k(0); k < sizes.size(); ++k) {
+            const size_t expected(std::min(TWR_BLOCK_SIZE, n - k * TWR_BLOCK_SIZE));
+            CHECK(sizes[k] == static_cast<int>(expected));
+        }
+    }
+}
+
+TEST_CASE("compressTWR writes the same frames on any number of threads", "[compress]") {
+    const std::string payload(makePayload(100 * TWR_BLOCK_SIZE + 5));
+    std::vector<char> serial;
+    compressTWR(payload.data(), payload.size(), serial);
+    CHECK(serial.size() < payload.size());
+
+    for (const size_t nThreads : {2, 3, 8, 0}) {
+        std::vector<char> frames;
+        compressTWR(payload.data(), payload.size(), frames, nThreads);
+        CHECK(frames == serial);
+    }
+
+    // Frames are appended after anything already in the buffer
+    std::vector<char> appended{'a', 'b'};
+    const size_t nAppended(compressTWR(payload.data(), payload.size(), appended, 4));
+    CHECK(nAppended == serial.size());
+    REQUIRE(appended.size() == serial.size() + 2);
+    CHECK(std::vector<char>(appended.begin() + 2, appended.end()) == serial);
+}
+
+TEST_CASE("DecompressTWR reads back what compressTWR writes", "[compress][decompress]") {
+    const std::string payload(makePayload(30 * TWR_BLOCK_SIZE + 77));
+    std::vector<char> frames;
+    compressTWR(payload.data(), payload.size(), frames, 4);
+    ScopedFile file(tempPath("compress"), frames);
+
+    SECTION("in bulk, on several threads") {
+        DecompressTWR is(file.path, true);
+        REQUIRE(is);
+        std::vector<char> all;
+        CHECK(is.readRemaining(all, 4) == payload.size());
+        CHECK(std::string(all.begin(), all.end()) == payload);
+    }
+
+    SECTION("through the stream, with a seek") {
+        DecompressTWR is(file.path, true);
+        std::string all(payload.size(), '\0');
+        REQUIRE(is.read(&all[0], static_cast<std::streamsize>(all.size())));
+        CHECK(all == payload);
+
+        std::string some(100, '\0');
+        REQUIRE(is.seekg(static_cast<std::streamoff>(5 * TWR_BLOCK_SIZE - 50)));
+        REQUIRE(is.read(&some[0], 100));
+        CHECK(some == payload.substr(5 * TWR_BLOCK_SIZE - 50, 100));
+    }
+}
@@ -2,11 +2,17 @@
 // via the integration suite but that a user can hit via CLI flag combinations.
 
 #include <catch2/catch_test_macros.hpp>
+#include "ByteCursor.H"
 #include "Data.H"
 #include "Sensor.H"
 #include "Sensors.H"
 #include "KnownBytes.H"
 #include "MyException.H"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
 #include <sstream>
 #include <string>
 #include <cstdint>
@@ -29,6 +35,32 @@ std::string makeNativeKnownBytes() {
     oss.write(reinterpret_cast<const char*>(&d), 8);
     return oss.str();
 }
+
+// Append value in native order, or byte reversed when qSwap
+template <class T> void put(std::string& s, const T value, const bool qSwap) {
+    std::string bytes(reinterpret_cast<const char*>(&value), sizeof(value));
+    if (qSwap) bytes.assign(bytes.rbegin(), bytes.rend());
+    s += bytes;
+}
+
+// Known bytes and a few records for sensors of widths 1, 2, 4, and 8
+std::string makeRecords(const bool qSwap) {
+    std::string s("sa");
+    put<int16_t>(s, 0x1234, qSwap);
+    put<float>(s, 123.456f, qSwap);
+    put<double>(s, 123456789.12345, qSwap);
+    for (int r(0); r < 10; ++r) {
+        s.push_back('d');
+        s.push_back(static_cast<char>((r % 2) ? 0x55 : 0xAA)); // Repeat or new
+        if (r % 2) continue;
+        put<int8_t>(s, static_cast<int8_t>(-r), qSwap);
+        put<int16_t>(s, static_cast<int16_t>(-1000 * r), qSwap);
+        put<float>(s, static_cast<float>(r) + 0.25f, qSwap);
+        put<double>(s, 1.0e9 * r + 0.125, qSwap);
+    }
+    s.push_back('X');
+    return s;
+}
 } // namespace
 
 TEST_CASE("Data::load rejects a zero-column selection", "[data]") {
@@ -49,3 +81,478 @@ TEST_CASE("Data::load rejects a zero-column selection", "[data]") {
     Data data;
     CHECK_THROWS_AS(data.load(dataStream, kb, sensors, false, 1024), MyException);
 }
+
+TEST_CASE("Data::load decodes both byte orders identically", "[data]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 1 s8 nodim"));
+    sensors.insert(Sensor("s: T 1 1 2 s16 nodim"));
+    sensors.insert(Sensor("s: T 2 2 4 s32 nodim"));
+    sensors.insert(Sensor("s: T 3 3 8 s64 nodim"));
+    sensors.nToStore(4);
+
+    Data results[2];
+    for (int q(0); q < 2; ++q) {
+        const std::string body(makeRecords(q == 1));
+        std::istringstream is(body, std::ios::binary);
+        const KnownBytes kb(is);
+        CHECK(kb.qFlip() == (q == 1));
+        results[q].load(is, kb, sensors, false, body.size());
+    }
+
+    REQUIRE(results[0].size() == 10);
+    REQUIRE(results[1].size() == results[0].size());
+    for (size_t j(0); j < 4; ++j) {
+        for (size_t i(0); i < results[0].size(); ++i) {
+            CHECK(results[1](i, j) == results[0](i, j));
+        }
+    }
+    CHECK(results[1](5, 1) == -4000); // Record 5 repeats record 4
+    CHECK(results[1](8, 3) == 8.0e9 + 0.125);
+}
+
+TEST_CASE("Data keeps each column at its sensor's native width", "[data]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 1 s8 nodim"));
+    sensors.insert(Sensor("s: T 1 1 2 s16 nodim"));
+    sensors.insert(Sensor("s: T 2 2 4 s32 nodim"));
+    sensors.insert(Sensor("s: T 3 3 8 s64 nodim"));
+    sensors.nToStore(5); // Column 4 has no sensor in this file
+
+    std::string body(makeNativeKnownBytes());
+    body.push_back('d');
+    body.push_back(static_cast<char>(0xAA)); // All four new
+    put<int8_t>(body, -5, false);
+    put<int16_t>(body, 1234, false);
+    put<float>(body, std::numeric_limits<float>::infinity(), false);
+    put<double>(body, 2.5, false);
+    body.push_back('d');
+    body.push_back(static_cast<char>(0x08)); // Only s32 new
+    put<float>(body, 0.5f, false);
+    body.push_back('d');
+    body.push_back(static_cast<char>(0x04)); // Only s32 repeats
+    body.push_back('X');
+
+    std::istringstream is(body, std::ios::binary);
+    const KnownBytes kb(is);
+    Data data;
+    data.load(is, kb, sensors, false, body.size());
+    REQUIRE(data.size() == 3);
+    REQUIRE(data.nColumns() == 5);
+
+    const Data::tColumn& s8(data.column(0));
+    REQUIRE(s8.width() == 1);
+    REQUIRE(s8.block<int8_t>(0) != nullptr);
+    CHECK(s8.block<double>(0) == nullptr);
+    CHECK(s8.block<int8_t>(0)[0] == -5);
+    CHECK(s8.block<int8_t>(0)[1] == Column::INT8_FILL);
+    CHECK(std::isnan(data(1, 0)));
+
+    const Data::tColumn& s16(data.column(1));
+    REQUIRE(s16.width() == 2);
+    CHECK(s16.block<int16_t>(0)[0] == 1234);
+    CHECK(s16.block<int16_t>(0)[2] == Column::INT16_FILL);
+
+    const Data::tColumn& s32(data.column(2));
+    REQUIRE(s32.width() == 4);
+    CHECK(std::isnan(s32.block<float>(0)[0])); // inf is stored as NaN
+    CHECK(s32.block<float>(0)[1] == 0.5f);
+    CHECK(s32.block<float>(0)[2] == 0.5f);
+
+    CHECK(data.column(3).block<double>(0)[0] == 2.5);
+
+    const Data::tColumn& untyped(data.column(4));
+    CHECK(untyped.width() == 0);
+    CHECK(untyped.size() == 3);
+    CHECK(std::isnan(data(2, 4)));
+}
+
+TEST_CASE("Data::integersAsFloat keeps readings equal to the integer fills", "[data]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 1 s8 nodim"));
+    sensors.insert(Sensor("s: T 1 1 2 s16 nodim"));
+    sensors.nToStore(2);
+
+    for (const bool qSwap : {false, true}) {
+        std::string body("sa");
+        put<int16_t>(body, 0x1234, qSwap);
+        put<float>(body, 123.456f, qSwap);
+        put<double>(body, 123456789.12345, qSwap);
+        body.push_back('d');
+        body.push_back(static_cast<char>(0x80)); // s8 new, s16 not yet seen
+        put<int8_t>(body, Column::INT8_FILL, qSwap);
+        body.push_back('d');
+        body.push_back(static_cast<char>(0x60)); // s8 repeats, s16 new
+        put<int16_t>(body, Column::INT16_FILL, qSwap);
+        body.push_back('d');
+        body.push_back(static_cast<char>(0x50)); // Both repeat
+        body.push_back('X');
+
+        std::istringstream is(body, std::ios::binary);
+        const KnownBytes kb(is);
+        Data data;
+        data.integersAsFloat(true);
+        data.load(is, kb, sensors, false, body.size());
+        REQUIRE(data.size() == 3);
+        CHECK(data.column(0).width() == 4);
+        CHECK(data.column(1).width() == 4);
+        for (size_t i(0); i < 3; ++i) {
+            CHECK(data(i, 0) == -127);
+        }
+        CHECK(std::isnan(data(0, 1))); // Really missing
+        CHECK(data(1, 1) == -32768);
+        CHECK(data(2, 1) == -32768);
+        CHECK(sensors[0].toStr(data(0, 0)) == "-127");
+        CHECK(sensors[1].toStr(data(1, 1)) == "-32768");
+    }
+}
+
+TEST_CASE("Data grows columns a block at a time and reuses the blocks", "[data]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 2 s16 nodim"));
+    sensors.insert(Sensor("s: T 1 1 8 s64 nodim"));
+    sensors.nToStore(2);
+
+    // Every record new for both sensors, or only s16 when qGaps and r is odd
+    auto makeBody = [](const size_t nRecords, const bool qGaps) {
+        std::string s(makeNativeKnownBytes());
+        for (size_t r(0); r < nRecords; ++r) {
+            const bool qBoth(!qGaps || !(r % 2));
+            s.push_back('d');
+            s.push_back(static_cast<char>(qBoth ? 0xA0 : 0x80));
+            put<int16_t>(s, static_cast<int16_t>(r), false);
+            if (qBoth) put<double>(s, 0.5 * r, false);
+        }
+        s.push_back('X');
+        return s;
+    };
+
+    const size_t nRows(2 * Column::BLOCK_ROWS + 5);
+    const std::string big(makeBody(nRows, false));
+    std::istringstream bigStream(big, std::ios::binary);
+    const KnownBytes kb(bigStream);
+    Data data;
+    data.load(bigStream, kb, sensors, false, 100); // nBytes no longer sizes
+
+    REQUIRE(data.size() == nRows);
+    CHECK(data.column(0).nBlocks() == 3);
+    for (const size_t r : {size_t(0), Column::BLOCK_ROWS - 1, Column::BLOCK_ROWS, nRows - 1}) {
+        CHECK(data(r, 0) == static_cast<double>(r));
+        CHECK(data(r, 1) == 0.5 * r);
+    }
+    CHECK(data.column(1).block<double>(1)[0] == 0.5 * Column::BLOCK_ROWS);
+    CHECK(data.peakBytes() == 3 * Column::BLOCK_ROWS * (2 + 8));
+
+    // A smaller file loaded into the same object gets recycled blocks, which
+    // must read as missing wherever this file has no value
+    const std::string small(makeBody(3, true));
+    std::istringstream smallStream(small, std::ios::binary);
+    const KnownBytes kbSmall(smallStream);
+    data.load(smallStream, kbSmall, sensors, false, small.size());
+
+    REQUIRE(data.size() == 3);
+    CHECK(data.column(1).nBlocks() == 1);
+    CHECK(data(1, 0) == 1.0);
+    CHECK(std::isnan(data(1, 1)));
+    CHECK(data(2, 1) == 1.0);
+    CHECK(data.peakBytes() == Column::BLOCK_ROWS * (2 + 8));
+}
+
+namespace {
+// Random records for sensors of widths 1, 2, 4, 8 in turn, where only every
+// third sensor selects rows, so many records add no row and leave values for
+// the next one. Idle stretches make repeats reach back across many records.
+std::string makeRandomRecords(const size_t nSensors, const size_t nRecords,
+                              const bool qSwap, const unsigned int seed) {
+    std::string s("sa");
+    put<int16_t>(s, 0x1234, qSwap);
+    put<float>(s, 123.456f, qSwap);
+    put<double>(s, 123456789.12345, qSwap);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned int> codes(nSensors);
+    for (size_t r(0); r < nRecords; ++r) {
+        s.push_back('d');
+        const unsigned int oneIn((r / 500) % 2 ? 40 : 3);
+        for (size_t i(0); i < nSensors; i += 4) {
+            uint8_t bits(0);
+            for (size_t k(0); (k < 4) && (i + k < nSensors); ++k) {
+                codes[i + k] = (rng() % oneIn) ? 0 : 1 + rng() % 2;
+                bits |= static_cast<uint8_t>(codes[i + k] << (6 - 2 * k));
+            }
+            s.push_back(static_cast<char>(bits));
+        }
+        for (size_t i(0); i < nSensors; ++i) {
+            if (codes[i] != 2) continue;
+            const int v(static_cast<int>(rng() % 20000) - 10000);
+            switch (i % 4) {
+                case 0: put<int8_t>(s, static_cast<int8_t>(v), qSwap); break;
+                case 1: put<int16_t>(s, static_cast<int16_t>(v), qSwap); break;
+                case 2: put<float>(s, (v % 7) ? v / 8.0f : INFINITY, qSwap); break;
+                default: put<double>(s, v * 1.5, qSwap); break;
+            }
+        }
+    }
+    s.push_back('X');
+    s.append("trailing");
+    return s;
+}
+
+Sensors makeRandomSensors(const size_t nSensors) {
+    static const char *sizes[] = {"1", "2", "4", "8"};
+    Sensors sensors;
+    for (size_t i(0); i < nSensors; ++i) {
+        sensors.insert(Sensor("s: T " + std::to_string(i) + " " + std::to_string(i) + " " +
+                              sizes[i % 4] + " v" + std::to_string(i) + " nodim"));
+        sensors[i].qCriteria((i % 3) == 0);
+    }
+    sensors.nToStore(nSensors);
+    return sensors;
+}
+
+// The same bytes in two columns, fill and NaN included
+void requireSameColumn(const Data::tColumn& x, const Data::tColumn& y) {
+    REQUIRE(x.size() == y.size());
+    REQUIRE(x.width() == y.width());
+    REQUIRE(x.nBlocks() == y.nBlocks());
+    for (size_t blk(0); blk < x.nBlocks(); ++blk) {
+        const size_t n(std::min(Column::BLOCK_ROWS, x.size() - blk * Column::BLOCK_ROWS));
+        const Data::tColumn& cx(x);
+        const Data::tColumn& cy(y);
+        const char *px(nullptr);
+        const char *py(nullptr);
+        switch (x.width()) {
+            case 1: px = reinterpret_cast<const char*>(cx.block<int8_t>(blk));
+                    py = reinterpret_cast<const char*>(cy.block<int8_t>(blk)); break;
+            case 2: px = reinterpret_cast<const char*>(cx.block<int16_t>(blk));
+                    py = reinterpret_cast<const char*>(cy.block<int16_t>(blk)); break;
+            case 4: px = reinterpret_cast<const char*>(cx.block<float>(blk));
+                    py = reinterpret_cast<const char*>(cy.block<float>(blk)); break;
+            default: px = reinterpret_cast<const char*>(cx.block<double>(blk));
+                     py = reinterpret_cast<const char*>(cy.block<double>(blk)); break;
+        }
+        CHECK(std::memcmp(px, py, n * x.width()) == 0);
+    }
+}
+
+// Same rows, and the same bytes in every column
+void requireIdentical(const Data& a, const Data& b) {
+    REQUIRE(a.size() == b.size());
+    REQUIRE(a.nColumns() == b.nColumns());
+    for (size_t j(0); j < a.nColumns(); ++j) {
+        requireSameColumn(a.column(j), b.column(j));
+    }
+}
+} // namespace
+
+TEST_CASE("Parallel Data::load matches the serial decoder bit for bit", "[data][parallel]") {
+    const size_t nSensors(37);
+    const Sensors sensors(makeRandomSensors(nSensors));
+
+    for (const bool qSwap : {false, true}) {
+        for (const size_t nThreads : {2, 3, 8}) {
+            const std::string body(makeRandomRecords(nSensors, 9000, qSwap, 7 + nThreads));
+
+            ByteCursor serialCursor(body.data(), body.data() + body.size());
+            const KnownBytes kb(serialCursor);
+            Data serial;
+            serial.load(serialCursor, kb, sensors, false, body.size());
+
+            ByteCursor parallelCursor(body.data(), body.data() + body.size());
+            const KnownBytes kbParallel(parallelCursor);
+            Data parallel;
+            parallel.threads(nThreads, 16);
+            parallel.load(parallelCursor, kbParallel, sensors, false, body.size());
+
+            requireIdentical(serial, parallel);
+            CHECK(parallelCursor.consumed() == serialCursor.consumed());
+            CHECK(parallel.size() > Column::BLOCK_ROWS); // Spans blocks
+        }
+    }
+}
+
+TEST_CASE("Parallel Data::load with integersAsFloat matches the native decode",
+          "[data][parallel]") {
+    const size_t nSensors(37);
+    const Sensors sensors(makeRandomSensors(nSensors));
+    const std::string body(makeRandomRecords(nSensors, 9000, false, 11));
+
+    ByteCursor nativeCursor(body.data(), body.data() + body.size());
+    const KnownBytes kb(nativeCursor);
+    Data native;
+    native.load(nativeCursor, kb, sensors, false, body.size());
+
+    ByteCursor serialCursor(body.data(), body.data() + body.size());
+    const KnownBytes kbSerial(serialCursor);
+    Data serial;
+    serial.integersAsFloat(true);
+    serial.load(serialCursor, kbSerial, sensors, false, body.size());
+
+    ByteCursor parallelCursor(body.data(), body.data() + body.size());
+    const KnownBytes kbParallel(parallelCursor);
+    Data parallel;
+    parallel.integersAsFloat(true);
+    parallel.threads(3, 16);
+    parallel.load(parallelCursor, kbParallel, sensors, false, body.size());
+
+    requireIdentical(serial, parallel);
+    REQUIRE(serial.size() == native.size());
+    size_t nFills(0);
+    for (size_t j(0); j < nSensors; ++j) {
+        const uint8_t width(native.column(j).width());
+        CHECK(serial.column(j).width() == (((width == 1) || (width == 2)) ? 4 : width));
+        for (size_t i(0); i < native.size(); ++i) {
+            const double a(native(i, j));
+            const double b(serial(i, j));
+            // Native integer fills read as NaN; widened, only the missing do
+            if (!std::isnan(a)) {
+                CHECK(b == a);
+            } else if (!std::isnan(b)) {
+                CHECK(b == ((width == 1) ? -127 : -32768));
+                ++nFills;
+            }
+        }
+    }
+    CHECK(nFills > 0); // Some readings equal a fill
+}
+
+TEST_CASE("Parallel Data::load falls back to the serial loop for damaged records",
+          "[data][parallel]") {
+    const size_t nSensors(12);
+    const Sensors sensors(makeRandomSensors(nSensors));
+    std::string body(makeRandomRecords(nSensors, 3000, false, 99));
+    body.insert(body.size() / 2, "garbage"); // A bad tag midway, repairable
+
+    for (const bool qRepair : {false, true}) {
+        Data results[2];
+        std::string errors[2];
+        for (int q(0); q < 2; ++q) {
+            ByteCursor cursor(body.data(), body.data() + body.size());
+            const KnownBytes kb(cursor);
+            if (q) results[q].threads(4, 16);
+            try {
+                results[q].load(cursor, kb, sensors, qRepair, body.size());
+            } catch (const MyException& e) {
+                errors[q] = e.what();
+            }
+        }
+        CHECK(errors[1] == errors[0]);
+        CHECK(errors[0].empty() == qRepair);
+        requireIdentical(results[0], results[1]);
+    }
+}
+
+TEST_CASE("Data::load with a projection matches the full decode's columns", "[data][projection]") {
+    const size_t nSensors(37);
+    const Sensors all(makeRandomSensors(nSensors));
+    // Keep every fifth sensor, so runs of unkept sensors, some of them
+    // criteria, lie between the kept ones
+    Sensors some(makeRandomSensors(nSensors));
+    std::vector<size_t> kept;
+    for (size_t i(0); i < nSensors; ++i) {
+        some[i].qKeep((i % 5) == 2);
+        if (some[i].qKeep()) {
+            some[i].index(static_cast<int>(kept.size()));
+            kept.push_back(i);
+        }
+    }
+    some.nToStore(kept.size());
+
+    for (const bool qSwap : {false, true}) {
+        const std::string body(makeRandomRecords(nSensors, 9000, qSwap, 31));
+        ByteCursor fullCursor(body.data(), body.data() + body.size());
+        const KnownBytes kb(fullCursor);
+        Data full;
+        full.load(fullCursor, kb, all, false, body.size());
+
+        for (const size_t nThreads : {1, 3}) {
+            ByteCursor cursor(body.data(), body.data() + body.size());
+            const KnownBytes kbSome(cursor);
+            Data data;
+            data.threads(nThreads, 16);
+            data.load(cursor, kbSome, some, false, body.size());
+
+            REQUIRE(data.nColumns() == kept.size());
+            for (size_t j(0); j < kept.size(); ++j) {
+                requireSameColumn(data.column(j), full.column(kept[j]));
+            }
+            CHECK(cursor.consumed() == fullCursor.consumed());
+        }
+    }
+}
+
+namespace {
+// Rows of makeRandomRecords(qSwap false) decoded one value at a time: every
+// record writes its values into the pending row, which becomes a row only
+// when a criteria sensor is active. Missing is NaN, as Column reads back.
+std::vector<std::vector<double>> referenceRows(const std::string& body,
+                                               const Sensors& sensors) {
+    const size_t nSensors(sensors.size());
+    const double missing(std::numeric_limits<double>::quiet_NaN());
+    std::vector<double> prev(nSensors, missing);
+    std::vector<double> row(nSensors, missing);
+    std::vector<std::vector<double>> rows;
+    size_t pos(16);
+    while (body[pos] == 'd') {
+        const size_t bits(pos + 1);
+        pos = bits + (nSensors + 3) / 4;
+        bool qSelected(false);
+        for (size_t i(0); i < nSensors; ++i) {
+            const unsigned int code((static_cast<uint8_t>(body[bits + i / 4]) >> (6 - 2 * (i % 4))) & 3);
+            if (code == 2) {
+                double v(0);
+                switch (i % 4) {
+                    case 0: {int8_t x; std::memcpy(&x, &body[pos], 1); v = (x == -127) ? missing : x; break;}
+                    case 1: {int16_t x; std::memcpy(&x, &body[pos], 2); v = (x == -32768) ? missing : x; break;}
+                    case 2: {float x; std::memcpy(&x, &body[pos], 4); v = std::isinf(x) ? missing : x; break;}
+                    default: {std::memcpy(&v, &body[pos], 8); break;}
+                }
+                pos += static_cast<size_t>(1) << (i % 4);
+                prev[i] = v;
+            }
+            if (code == 1 || code == 2) {
+                row[i] = prev[i];
+                qSelected |= sensors[i].qCriteria();
+            }
+        }
+        if (qSelected) {
+            rows.push_back(row);
+            row.assign(nSensors, missing);
+        }
+    }
+    return rows;
+}
+} // namespace
+
+TEST_CASE("Data::load with sparse criteria matches a value-by-value decode",
+          "[data][criteria]") {
+    // One criteria sensor, so most records add no row and their values are
+    // settled into the next row only when one does
+    const size_t nSensors(37);
+    Sensors sensors(makeRandomSensors(nSensors));
+    for (size_t i(0); i < nSensors; ++i) {
+        sensors[i].qCriteria(i == 5);
+    }
+    const std::string body(makeRandomRecords(nSensors, 9000, false, 57));
+    const std::vector<std::vector<double>> expected(referenceRows(body, sensors));
+    REQUIRE(expected.size() > 100);
+    REQUIRE(expected.size() < 4000);
+
+    for (const size_t nThreads : {1, 3}) {
+        ByteCursor cursor(body.data(), body.data() + body.size());
+        const KnownBytes kb(cursor);
+        Data data;
+        data.threads(nThreads, 16);
+        data.load(cursor, kb, sensors, false, body.size());
+
+        REQUIRE(data.size() == expected.size());
+        size_t nMismatched(0);
+        for (size_t r(0); r < expected.size(); ++r) {
+            for (size_t j(0); j < nSensors; ++j) {
+                const double x(data(r, j));
+                const double y(expected[r][j]);
+                if (!((x == y) || (std::isnan(x) && std::isnan(y)))) ++nMismatched;
+            }
+        }
+        CHECK(nMismatched == 0);
+    }
+}
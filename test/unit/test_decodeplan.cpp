@@ -0,0 +1,172 @@
+// Unit tests for DecodePlan, the flattened per-CRC view of a sensor list that
+// Data::load's record loop runs from.
+
+#include <catch2/catch_test_macros.hpp>
+#include "DecodePlan.H"
+#include "Data.H"
+#include "Header.H"
+#include "KnownBytes.H"
+#include "MyException.H"
+#include "Sensors.H"
+#include "SensorsMap.H"
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace {
+template <class T> void put(std::string& s, const T value) {
+    s.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::string makeHeader(const std::string& crc, int nSensors) {
+    std::ostringstream oss;
+    oss << "num_ascii_tags: 4\n"
+        << "total_num_sensors: " << nSensors << "\n"
+        << "sensor_list_factored: 0\n"
+        << "sensor_list_crc: " << crc << "\n";
+    return oss.str();
+}
+} // namespace
+
+TEST_CASE("DecodePlan flattens widths, columns, and flags", "[decodeplan]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 8 m_present_time timestamp"));
+    sensors.insert(Sensor("s: T 1 1 4 m_depth m"));
+    sensors.insert(Sensor("s: T 2 2 1 m_flag bool"));
+    sensors.nToStore(3);
+    sensors[2].qCriteria(false);
+
+    const DecodePlan plan(sensors);
+    REQUIRE(plan.size() == 3);
+    CHECK(plan.nColumns() == 3);
+    CHECK(plan.widths()[0] == 8);
+    CHECK(plan.widths()[1] == 4);
+    CHECK(plan.widths()[2] == 1);
+    CHECK(plan.columns()[1] == 1);
+    CHECK(plan.keeps()[2] == 1);
+    CHECK(plan.criteria()[0] == 1);
+    CHECK(plan.criteria()[2] == 0);
+}
+
+TEST_CASE("DecodePlan visits kept sensors and unsupported widths", "[decodeplan]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 8 m_present_time timestamp"));
+    sensors.insert(Sensor("s: T 1 1 4 m_depth m"));
+    sensors.insert(Sensor("s: T 2 2 16 m_odd nodim")); // No supported width
+    sensors.nToStore(1);
+    sensors[1].qKeep(false); // Still a criteria sensor, but its value is unused
+    sensors[2].qKeep(false);
+
+    const DecodePlan plan(sensors);
+    CHECK(plan.visits()[0] == 1);
+    CHECK(plan.visits()[1] == 0);
+    CHECK(plan.visits()[2] == 1); // Visited only so its size is reported
+}
+
+TEST_CASE("An unkept sensor of an unsupported size still fails the load",
+          "[decodeplan][data]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 4 m_depth m"));
+    sensors.insert(Sensor("s: T 1 1 3 m_odd nodim"));
+    sensors.nToStore(1);
+    sensors[1].qKeep(false);
+
+    const DecodePlan plan(sensors);
+    CHECK(plan.widths()[1] == 0);
+    CHECK(plan.visits()[1] == 1);
+
+    std::string body("sa");
+    put<int16_t>(body, 0x1234);
+    put<float>(body, 123.456f);
+    put<double>(body, 123456789.12345);
+    body.push_back('d');
+    body.push_back(static_cast<char>(0xA0)); // Both sensors new
+    put<float>(body, 1.0f);
+    body.append(3, '\0');
+    body.push_back('X');
+
+    std::istringstream is(body, std::ios::binary);
+    const KnownBytes kb(is);
+    Data data;
+    CHECK_THROWS_AS(data.load(is, kb, sensors, false, body.size()), MyException);
+}
+
+TEST_CASE("DecodePlan validates only kept sensors' columns", "[decodeplan]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 4 m_depth m"));
+    sensors.insert(Sensor("s: T 1 7 4 m_roll rad")); // Index beyond nToStore
+    sensors.nToStore(1);
+
+    CHECK_THROWS_AS(DecodePlan(sensors), MyException);
+
+    sensors[1].qKeep(false); // Not stored, so its stale index is irrelevant
+    CHECK_NOTHROW(DecodePlan(sensors));
+}
+
+TEST_CASE("Sensors drops a compiled plan when it changes", "[decodeplan][sensors]") {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 4 m_depth m"));
+    sensors.nToStore(1);
+    sensors.compilePlan();
+    REQUIRE(sensors.qPlan());
+    CHECK(sensors.plan().size() == 1);
+
+    sensors.qKeep(Sensors::tNames{"m_depth"});
+    CHECK_FALSE(sensors.qPlan());
+
+    sensors.compilePlan();
+    sensors.insert(Sensor("s: T 1 1 4 m_roll rad"));
+    CHECK_FALSE(sensors.qPlan());
+}
+
+TEST_CASE("SensorsMap::setUpForData compiles a plan per CRC", "[decodeplan][sensorsmap]") {
+    SensorsMap map;
+    std::istringstream hs(makeHeader("AAAA", 2));
+    Header hdr(hs, "groupA");
+    std::istringstream ss("s: T 0 0 4 m_depth m\ns: T 1 1 4 m_roll rad\n");
+    map.insert(ss, hdr, false);
+    map.setUpForData();
+
+    const Sensors& sensors(map.find(hdr));
+    REQUIRE(sensors.qPlan());
+    CHECK(sensors.plan().size() == 2);
+    CHECK(sensors.plan().nColumns() == 2);
+}
+
+TEST_CASE("Records decode when unkept sensors carry stale indices",
+          "[decodeplan][data][regression]") {
+    // With -k, SensorsMap::setUpForData only renumbers the kept sensors, so the
+    // others keep the index from their sensor line. Data::load used to bounds
+    // check every sensor that had a value, so a file whose unkept sensors had
+    // indices past the kept column count lost every record.
+    SensorsMap map;
+    std::istringstream hs(makeHeader("AAAA", 3));
+    Header hdr(hs, "groupA");
+    std::istringstream ss("s: T 0 0 4 m_depth m\n"
+                          "s: T 1 1 4 m_roll rad\n"
+                          "s: T 2 2 4 m_pitch rad\n");
+    map.insert(ss, hdr, false);
+    map.qKeep(Sensors::tNames{"m_depth"});
+    map.setUpForData();
+
+    std::string body("sa");
+    put<int16_t>(body, 0x1234);
+    put<float>(body, 123.456f);
+    put<double>(body, 123456789.12345);
+    for (int r(0); r < 3; ++r) {
+        body.push_back('d');
+        body.push_back(static_cast<char>(0xA8)); // All three sensors new
+        put<float>(body, static_cast<float>(r));
+        put<float>(body, 10.0f);
+        put<float>(body, 20.0f);
+    }
+    body.push_back('X');
+
+    std::istringstream is(body, std::ios::binary);
+    const KnownBytes kb(is);
+    Data data;
+    REQUIRE_NOTHROW(data.load(is, kb, map.find(hdr), false, body.size()));
+    REQUIRE(data.size() == 3);
+    REQUIRE(data.nColumns() == 1);
+    CHECK(data(2, 0) == 2.0);
+}
@@ -0,0 +1,151 @@
+// Unit tests for HeaderProbe, which reads a file's ASCII header without a
+// DecompressTWR stream and must agree with reading it through one.
+
+#include <catch2/catch_test_macros.hpp>
+#include "HeaderProbe.H"
+#include "Header.H"
+#include "Compress.H"
+#include "Decompress.H"
+#include "SensorsMap.H"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string tempPath(const std::string& stem, const std::string& ext) {
+    std::mt19937 rng{std::random_device{}()};
+    return (fs::temp_directory_path() /
+            ("dbd2netcdf_test_" + stem + "_" + std::to_string(rng()) + ext)).string();
+}
+
+// Written as given for a .?bd path, TWR compressed for a .?cd path
+struct ScopedFile {
+    std::string path;
+    ScopedFile(std::string p, const std::string& contents) : path(std::move(p)) {
+        std::vector<char> bytes(contents.begin(), contents.end());
+        if (qCompressed(path)) {
+            bytes.clear();
+            compressTWR(contents.data(), contents.size(), bytes);
+        }
+        std::ofstream os(path, std::ios::binary);
+        os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    ~ScopedFile() {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    ScopedFile(const ScopedFile&) = delete;
+    ScopedFile& operator=(const ScopedFile&) = delete;
+};
+
+// A header of nTags lines, each padded to about width bytes, then two sensor
+// lines and some binary bytes
+std::string makeFile(const int nTags, const size_t width = 0) {
+    std::ostringstream oss;
+    oss << "num_ascii_tags: " << nTags << "\n"
+        << "total_num_sensors: 2\n"
+        << "sensor_list_factored: 0\n"
+        << "sensor_list_crc: ABCD1234\n";
+    for (int i(4); i < nTags; ++i) {
+        oss << "tag_" << i << ": " << std::string(width, 'x') << "\n";
+    }
+    oss << "s: T 0 0 4 m_depth m\n"
+        << "s: T 1 1 8 m_present_time timestamp\n"
+        << std::string("s\0a\x34\x12", 5) << std::string(100000, '\x55');
+    return oss.str();
+}
+
+// What the first pass did before: a stream, the header, and where it ended
+void requireSameAsStream(const HeaderProbe& probe, const std::string& path) {
+    DecompressTWR is(path, qCompressed(path));
+    const Header hdr(is, path.c_str());
+    std::ostringstream expected, actual;
+    expected << hdr;
+    actual << probe.header();
+    CHECK(actual.str() == expected.str());
+    CHECK(probe.header().crc() == hdr.crc());
+    if (!is.eof()) {
+        CHECK(probe.sensorOffset() == static_cast<size_t>(is.tellg()));
+    }
+}
+} // namespace
+
+TEST_CASE("HeaderProbe reads the header and where the sensors start", "[headerprobe]") {
+    const std::string contents(makeFile(14));
+    const size_t offset(contents.find("s: T 0"));
+
+    for (const std::string ext : {".dbd", ".dcd"}) {
+        ScopedFile file(tempPath("probe", ext), contents);
+        const HeaderProbe probe(file.path, qCompressed(file.path));
+        REQUIRE(probe.qOpen());
+        CHECK(probe.qCompressed() == (ext == ".dcd"));
+        CHECK(probe.header().crc() == "ABCD1234");
+        CHECK(probe.header().nSensors() == 2);
+        CHECK(probe.sensorOffset() == offset);
+        requireSameAsStream(probe, file.path);
+    }
+}
+
+TEST_CASE("HeaderProbe grows its prefix for long headers", "[headerprobe]") {
+    // Past the first read, past the first LZ4 block, and past MAX_PREFIX
+    for (const size_t width : {size_t(100), size_t(1000), size_t(200)}) {
+        const int nTags(width == 200 ? 6000 : 100);
+        const std::string contents(makeFile(nTags, width));
+        for (const std::string ext : {".ebd", ".ecd"}) {
+            ScopedFile file(tempPath("long", ext), contents);
+            const HeaderProbe probe(file.path, qCompressed(file.path));
+            REQUIRE(probe.qOpen());
+            CHECK(probe.header().find("tag_" + std::to_string(nTags - 1)) == std::string(width, 'x'));
+            CHECK(probe.sensorOffset() == contents.find("s: T 0"));
+            requireSameAsStream(probe, file.path);
+        }
+    }
+}
+
+TEST_CASE("HeaderProbe agrees with a stream on short and odd files", "[headerprobe]") {
+    const std::string full(makeFile(14));
+    const std::vector<std::string> cases{
+        std::string(),                       // Empty
+        full.substr(0, 60),                  // Ends inside the header
+        "no colon here\nsecond: line\n",     // Not a DBD header
+        std::string(10000, 'z'),             // One very long line
+    };
+    for (const std::string& contents : cases) {
+        for (const std::string ext : {".sbd", ".scd"}) {
+            ScopedFile file(tempPath("odd", ext), contents);
+            const HeaderProbe probe(file.path, qCompressed(file.path));
+            REQUIRE(probe.qOpen());
+            requireSameAsStream(probe, file.path);
+        }
+    }
+}
+
+TEST_CASE("HeaderProbe reports a missing file", "[headerprobe]") {
+    const HeaderProbe probe(tempPath("missing", ".dbd"), false);
+    CHECK_FALSE(probe.qOpen());
+    CHECK(probe.header().empty());
+}
+
+TEST_CASE("SensorsMap reads a probed file's sensors once per CRC", "[headerprobe][sensorsmap]") {
+    ScopedFile dbd(tempPath("map", ".dbd"), makeFile(14));
+    ScopedFile dcd(tempPath("map", ".dcd"), makeFile(14));
+
+    SensorsMap smap;
+    const HeaderProbe first(dcd.path, true);
+    smap.insert(first);
+    const Sensors& sensors(smap.find(first.header()));
+    REQUIRE(sensors.size() == 2);
+    CHECK(sensors[0].name() == "m_depth");
+    CHECK(sensors[1].name() == "m_present_time");
+
+    // Known now, so the file is not opened again, even once it has gone
+    const HeaderProbe second(dbd.path, false);
+    fs::remove(dbd.path);
+    REQUIRE_NOTHROW(smap.insert(second));
+    CHECK(smap.find(second.header()).size() == 2);
+}
@@ -26,6 +26,18 @@ namespace {
         oss.write(reinterpret_cast<const char*>(&d), 8);
         return oss.str();
     }
+
+    // The same value with its bytes in the opposite order, as written by a
+    // host of the other endianness.
+    template <class T> std::string swapped(const T value) {
+        std::string s(reinterpret_cast<const char*>(&value), sizeof(value));
+        return std::string(s.rbegin(), s.rend());
+    }
+
+    std::string makeSwappedKnownBytes() {
+        return std::string("sa") + swapped<int16_t>(0x1234) + swapped(123.456f) +
+               swapped(123456789.12345);
+    }
 }
 
 TEST_CASE("KnownBytes constructor validates the 16-byte header", "[knownbytes]") {
@@ -118,3 +130,20 @@ TEST_CASE("KnownBytes read methods round-trip native-order values", "[knownbytes
         CHECK_THROWS_AS(kb.read16(iss), MyException);
     }
 }
+
+TEST_CASE("KnownBytes decodes values written in the other byte order", "[knownbytes]") {
+    const std::string header = makeSwappedKnownBytes();
+    std::istringstream headerStream(header, std::ios::binary);
+    KnownBytes kb(headerStream);
+    CHECK(kb.qFlip());
+
+    std::istringstream iss(swapped<int16_t>(-12345) + swapped(3.14159f) +
+                           swapped(-2.718281828459045), std::ios::binary);
+    CHECK(kb.read16(iss) == -12345);
+    CHECK(kb.read32(iss) == 3.14159f);
+    CHECK(kb.read64(iss) == -2.718281828459045);
+
+    const std::string native = makeNativeKnownBytes();
+    std::istringstream nativeStream(native, std::ios::binary);
+    CHECK_FALSE(KnownBytes(nativeStream).qFlip());
+}
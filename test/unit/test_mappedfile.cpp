@@ -0,0 +1,185 @@
+// Unit tests for MappedFile and the in-place (mapped) decode path through
+// DecompressTWR, which must produce exactly what the istream path produces.
+
+#include <catch2/catch_test_macros.hpp>
+#include "MappedFile.H"
+#include "Decompress.H"
+#include "Data.H"
+#include "Sensor.H"
+#include "Sensors.H"
+#include "KnownBytes.H"
+#include "MyException.H"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string tempPath(const std::string& stem) {
+    std::mt19937 rng{std::random_device{}()};
+    return (fs::temp_directory_path() /
+            ("dbd2netcdf_test_" + stem + "_" + std::to_string(rng()) + ".dbd")).string();
+}
+
+struct ScopedFile {
+    std::string path;
+    ScopedFile(std::string p, const std::string& contents) : path(std::move(p)) {
+        std::ofstream os(path, std::ios::binary);
+        os.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+    ~ScopedFile() {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    ScopedFile(const ScopedFile&) = delete;
+    ScopedFile& operator=(const ScopedFile&) = delete;
+};
+
+template <class T> void put(std::string& s, const T value) {
+    s.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Known bytes block followed by records for four sensors of widths 1, 2, 4, 8.
+// Each record is 'd', one byte of 2-bit state codes, then the new values.
+std::string makeBody() {
+    std::string s("sa");
+    put<int16_t>(s, 0x1234);
+    put<float>(s, 123.456f);
+    put<double>(s, 123456789.12345);
+
+    for (int r(0); r < 50; ++r) {
+        s.push_back('d');
+        // Sensors 0..3 in the high to low bit pairs: alternate new and repeat
+        const uint8_t codes((r % 2) ? 0x55 : 0xAA);
+        s.push_back(static_cast<char>(codes));
+        if (!(r % 2)) {
+            put<int8_t>(s, static_cast<int8_t>(r - 20));
+            put<int16_t>(s, static_cast<int16_t>(r * 300));
+            put<float>(s, static_cast<float>(r) / 4);
+            put<double>(s, r * 1.0e6 + 0.5);
+        }
+    }
+    s.push_back('X');
+    return s;
+}
+
+Sensors makeSensors() {
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 1 s8 nodim"));
+    sensors.insert(Sensor("s: T 1 1 2 s16 nodim"));
+    sensors.insert(Sensor("s: T 2 2 4 s32 nodim"));
+    sensors.insert(Sensor("s: T 3 3 8 s64 nodim"));
+    sensors.nToStore(4);
+    return sensors;
+}
+} // namespace
+
+TEST_CASE("MappedFile exposes a file's bytes", "[mappedfile]") {
+    const std::string contents("hello mapped world");
+    ScopedFile file(tempPath("mapped"), contents);
+
+    MappedFile mf(file.path);
+    REQUIRE(mf.qOpen());
+    REQUIRE(mf.size() == contents.size());
+    CHECK(std::string(mf.data(), mf.size()) == contents);
+
+    mf.close();
+    CHECK_FALSE(mf.qOpen());
+    CHECK(mf.size() == 0);
+}
+
+TEST_CASE("MappedFile handles empty and missing files", "[mappedfile]") {
+    ScopedFile empty(tempPath("empty"), std::string());
+    MappedFile mf(empty.path);
+    CHECK(mf.qOpen());
+    CHECK(mf.size() == 0);
+
+    MappedFile missing(empty.path + ".does-not-exist");
+    CHECK_FALSE(missing.qOpen());
+}
+
+TEST_CASE("Uncompressed DecompressTWR is seekable", "[mappedfile]") {
+    ScopedFile file(tempPath("seek"), "line one\nline two\n");
+    DecompressTWR is(file.path, false);
+    REQUIRE(is);
+    REQUIRE(is.qInPlace());
+
+    std::string line;
+    REQUIRE(std::getline(is, line));
+    CHECK(line == "line one");
+    CHECK(is.tellg() == std::streampos(9));
+
+    is.seekg(5);
+    REQUIRE(std::getline(is, line));
+    CHECK(line == "one");
+
+    is.seekg(-4, std::ios::end);
+    REQUIRE(std::getline(is, line));
+    CHECK(line == "two");
+}
+
+TEST_CASE("Compressed DecompressTWR decompresses from the mapping", "[mappedfile][decompress]") {
+    // Two TWR frames of one literal-only LZ4 block each, then a stray byte
+    // too short to be a length
+    const std::string frames(std::string("\x00\x06\x50hello\x00\x04\x30 hi", 14) + '\x01');
+    ScopedFile file(tempPath("frames"), frames);
+    DecompressTWR is(file.path, true);
+    REQUIRE(is);
+    CHECK_FALSE(is.qInPlace());
+
+    std::string all;
+    REQUIRE(std::getline(is, all));
+    CHECK(all == "hello hi");
+    CHECK(is.eof());
+}
+
+TEST_CASE("Mapped and istream decode paths agree", "[mappedfile][data]") {
+    const std::string body(makeBody());
+    ScopedFile file(tempPath("decode"), body);
+    const Sensors sensors(makeSensors());
+
+    std::istringstream iss(body, std::ios::binary);
+    const KnownBytes kbStream(iss);
+    Data viaStream;
+    viaStream.load(iss, kbStream, sensors, false, body.size());
+
+    DecompressTWR twr(file.path, false);
+    REQUIRE(twr.qInPlace());
+    const KnownBytes kbMapped(twr);
+    Data viaMap;
+    viaMap.load(twr, kbMapped, sensors, false, body.size());
+
+    REQUIRE(viaMap.size() == 50);
+    REQUIRE(viaStream.size() == viaMap.size());
+    REQUIRE(viaStream.nColumns() == viaMap.nColumns());
+    for (size_t j(0); j < viaMap.nColumns(); ++j) {
+        for (size_t i(0); i < viaMap.size(); ++i) {
+            const double a(viaStream(i, j));
+            const double b(viaMap(i, j));
+            CHECK(((std::isnan(a) && std::isnan(b)) || (a == b)));
+        }
+    }
+    CHECK(viaMap(3, 1) == 2 * 300); // Row 3 repeats row 2's int16
+    CHECK(viaMap(4, 3) == 4.0e6 + 0.5);
+
+    // The stream position ends just past the 'X' tag, as with the istream
+    CHECK(twr.tellg() == std::streampos(static_cast<std::streamoff>(body.size())));
+}
+
+TEST_CASE("Mapped decode reports a truncated value", "[mappedfile][data]") {
+    std::string body(makeBody());
+    body.resize(16 + 2 + 5); // Known bytes, tag, state, and half the values
+    ScopedFile file(tempPath("short"), body);
+
+    DecompressTWR twr(file.path, false);
+    const KnownBytes kb(twr);
+    Data data;
+    CHECK_THROWS_AS(data.load(twr, kb, makeSensors(), false, body.size()), MyException);
+    CHECK(data.empty());
+}
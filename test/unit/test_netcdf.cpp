@@ -7,10 +7,12 @@
 #include "MyNetCDF.H"
 #include "MyException.H"
 #include <netcdf.h>
+#include <cmath>
 #include <filesystem>
 #include <random>
 #include <string>
 #include <system_error>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -34,6 +36,40 @@ struct ScopedFile {
     ScopedFile(const ScopedFile&) = delete;
     ScopedFile& operator=(const ScopedFile&) = delete;
 };
+
+// Write values through NetCDF::putVara into a variable of type idType, in
+// two hyperslabs, and read them back as doubles
+template <class T>
+std::vector<double> roundTrip(const std::string& stem, const nc_type idType,
+                              const std::vector<T>& values) {
+    ScopedFile file(tempNcPath(stem));
+    {
+        NetCDF nc(file.path, false);
+        const int dim = nc.maybeCreateDim("i");
+        const int var = nc.createVar("x", idType, dim, "m");
+        const size_t half = values.size() / 2;
+        nc.putVara(var, static_cast<size_t>(0), half, values.data());
+        nc.putVara(var, half, values.size() - half, values.data() + half);
+    }
+
+    int ncid = -1, varid = -1;
+    REQUIRE(nc_open(file.path.c_str(), NC_NOWRITE, &ncid) == NC_NOERR);
+    REQUIRE(nc_inq_varid(ncid, "x", &varid) == NC_NOERR);
+    std::vector<double> out(values.size());
+    const size_t start = 0, count = values.size();
+    CHECK(nc_get_vara_double(ncid, varid, &start, &count, out.data()) == NC_NOERR);
+    nc_close(ncid);
+    return out;
+}
+
+template <class T>
+void checkRoundTrip(const std::string& stem, const nc_type idType, const std::vector<T>& values) {
+    const std::vector<double> got(roundTrip(stem, idType, values));
+    REQUIRE(got.size() == values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK(got[i] == static_cast<double>(values[i]));
+    }
+}
 } // namespace
 
 TEST_CASE("NetCDF::maybeCreateVar round-trips on a compatible reopen",
@@ -123,3 +159,136 @@ TEST_CASE("NetCDF::maybeCreateDim rejects a fixed-length existing dim",
     NetCDF nc(file.path, true);
     CHECK_THROWS_AS(nc.maybeCreateDim("i"), MyException);
 }
+
+TEST_CASE("NetCDF::putVara writes each type into its own variable type",
+          "[netcdf][putvara]") {
+    checkRoundTrip<int8_t>("put_byte", NC_BYTE, {-127, -1, 0, 1, 126});
+    checkRoundTrip<uint8_t>("put_ubyte", NC_UBYTE, {0, 1, 128, 254});
+    checkRoundTrip<int16_t>("put_short", NC_SHORT, {-32767, -1, 0, 1, 32766});
+    checkRoundTrip<uint16_t>("put_ushort", NC_USHORT, {0, 1, 32768, 65534});
+    checkRoundTrip<int32_t>("put_int", NC_INT, {-2147483647, -1, 0, 1, 2147483646});
+    checkRoundTrip<uint32_t>("put_uint", NC_UINT, {0u, 1u, 2147483648u, 4294967294u});
+    checkRoundTrip<float>("put_float", NC_FLOAT, {-1.5f, 0.0f, 3.25f, 1.0e30f});
+    checkRoundTrip<double>("put_double", NC_DOUBLE, {-1.5, 0.0, 3.25, 1.0e300});
+}
+
+TEST_CASE("NetCDF::maybeCreateVar remembers the variables it has validated",
+          "[netcdf][schema]") {
+    ScopedFile file(tempNcPath("var_cache"));
+
+    NetCDF nc(file.path, false);
+    const int dim = nc.maybeCreateDim("i");
+    const int var = nc.maybeCreateVar("x", NC_FLOAT, dim, "m");
+    CHECK(nc.maybeCreateVar("x", NC_FLOAT, dim, "m") == var);
+    // A remembered name asked for with another type is still rejected
+    CHECK_THROWS_AS(nc.maybeCreateVar("x", NC_DOUBLE, dim, "m"), MyException);
+}
+
+TEST_CASE("NetCDF keeps writing after a sync and a chunk cache release",
+          "[netcdf][batch]") {
+    ScopedFile file(tempNcPath("release"));
+    const std::vector<float> first{1.0f, 2.0f, 3.0f};
+    const std::vector<float> second{4.0f, 5.0f};
+
+    {
+        NetCDF nc(file.path, false);
+        const int dim = nc.maybeCreateDim("i");
+        const int var = nc.maybeCreateVar("x", NC_FLOAT, dim, "m");
+        nc.putVara(var, static_cast<size_t>(0), first.size(), first.data());
+        nc.sync();
+        nc.releaseChunkCaches();
+        CHECK(nc.maybeCreateVar("x", NC_FLOAT, dim, "m") == var);
+        nc.putVara(var, first.size(), second.size(), second.data());
+        CHECK(nc.lengthDim(dim) == first.size() + second.size());
+    }
+
+    int ncid = -1, varid = -1;
+    REQUIRE(nc_open(file.path.c_str(), NC_NOWRITE, &ncid) == NC_NOERR);
+    REQUIRE(nc_inq_varid(ncid, "x", &varid) == NC_NOERR);
+    std::vector<double> got(first.size() + second.size());
+    const size_t start = 0, count = got.size();
+    CHECK(nc_get_vara_double(ncid, varid, &start, &count, got.data()) == NC_NOERR);
+    nc_close(ncid);
+    CHECK(got == std::vector<double>{1, 2, 3, 4, 5});
+}
+
+TEST_CASE("NetCDF::putVaraBuffered writes what putVara would",
+          "[netcdf][buffered]") {
+    ScopedFile file(tempNcPath("buffered"));
+    // Record ranges written, out of order within a chunk of 10 and with gaps
+    // inside and across chunks; the last ends part way through a chunk
+    const std::vector<std::pair<size_t, size_t> > ranges{
+        {0, 3}, {3, 7}, {8, 12}, {25, 27}, {30, 45}};
+    const size_t n = 45;
+
+    {
+        NetCDF nc(file.path, false);
+        nc.chunkSize(10);
+        const int dim = nc.maybeCreateDim("i");
+        const int var = nc.createVar("x", NC_FLOAT, dim, "m");
+        for (const auto& range : ranges) {
+            std::vector<float> values;
+            for (size_t k = range.first; k < range.second; ++k) {
+                values.push_back(static_cast<float>(k));
+            }
+            nc.putVaraBuffered(var, range.first, values.size(), values.data());
+        }
+    } // close() writes the partial chunk
+
+    int ncid = -1, varid = -1;
+    REQUIRE(nc_open(file.path.c_str(), NC_NOWRITE, &ncid) == NC_NOERR);
+    REQUIRE(nc_inq_varid(ncid, "x", &varid) == NC_NOERR);
+    std::vector<double> got(n);
+    const size_t start = 0, count = n;
+    CHECK(nc_get_vara_double(ncid, varid, &start, &count, got.data()) == NC_NOERR);
+    nc_close(ncid);
+
+    for (size_t k = 0; k < n; ++k) {
+        bool written = false;
+        for (const auto& range : ranges) {
+            written = written || (k >= range.first && k < range.second);
+        }
+        INFO("record " << k);
+        if (written) {
+            CHECK(got[k] == static_cast<double>(k));
+        } else {
+            CHECK(std::isnan(got[k]));
+        }
+    }
+}
+
+TEST_CASE("NetCDF::chunkBytes sizes chunks by bytes and expected length",
+          "[netcdf][chunking]") {
+    ScopedFile file(tempNcPath("auto_chunk"));
+    {
+        NetCDF nc(file.path, false);
+        nc.chunkBytes(4096);
+        const int iDim = nc.maybeCreateDim("i");
+        const int jDim = nc.maybeCreateDim("j");
+        const int kDim = nc.createDim("k", 4);
+        nc.expectedLength(jDim, 100);
+
+        nc.createVar("x", NC_DOUBLE, iDim, "m");   // 4096 / 8 records
+        nc.createVar("b", NC_BYTE, iDim, "m");     // 4096 / 1 records
+        nc.createVar("y", NC_DOUBLE, jDim, "m");   // Only 100 expected
+        const int dims[] = {iDim, kDim};
+        nc.createVar("z", NC_SHORT, dims, 2, "m"); // 4096 / 2 / 4 rows of 4
+        nc.logChunking();
+    }
+
+    int ncid = -1;
+    REQUIRE(nc_open(file.path.c_str(), NC_NOWRITE, &ncid) == NC_NOERR);
+    auto chunking = [ncid](const char* name) {
+        int varid = -1, storage = -1;
+        std::vector<size_t> chunks(2, 0);
+        REQUIRE(nc_inq_varid(ncid, name, &varid) == NC_NOERR);
+        REQUIRE(nc_inq_var_chunking(ncid, varid, &storage, chunks.data()) == NC_NOERR);
+        CHECK(storage == NC_CHUNKED);
+        return chunks;
+    };
+    CHECK(chunking("x")[0] == 512);
+    CHECK(chunking("b")[0] == 4096);
+    CHECK(chunking("y")[0] == 100);
+    CHECK(chunking("z") == std::vector<size_t>{512, 4});
+    nc_close(ncid);
+}
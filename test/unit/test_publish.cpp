@@ -0,0 +1,101 @@
+// Unit tests for publish(), which writes a file through a temporary file
+// and renames it into place.
+
+#include <catch2/catch_test_macros.hpp>
+#include "Publish.H"
+#include "MyException.H"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <random>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+struct ScopedDir {
+    fs::path path;
+    ScopedDir() {
+        std::mt19937 rng{std::random_device{}()};
+        path = fs::temp_directory_path() / ("dbd2netcdf_test_publish_" + std::to_string(rng()));
+        fs::create_directories(path);
+    }
+    ~ScopedDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+    ScopedDir(const ScopedDir&) = delete;
+    ScopedDir& operator=(const ScopedDir&) = delete;
+
+    size_t nEntries() const {
+        return static_cast<size_t>(std::distance(fs::directory_iterator(path), fs::directory_iterator()));
+    }
+};
+
+std::string slurp(const fs::path& fn) {
+    std::ifstream is(fn, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+TEST_CASE("publish writes the whole file and leaves no temporary behind", "[publish]") {
+    ScopedDir dir;
+    const fs::path fn(dir.path / "out.bin");
+    const std::string data("abc\0def\n", 8);
+
+    publish(fn.string(), data.data(), data.size());
+    CHECK(slurp(fn) == data);
+    CHECK(dir.nEntries() == 1);
+
+    SECTION("an existing file is replaced") {
+        publish(fn.string(), "xy", 2);
+        CHECK(slurp(fn) == "xy");
+        CHECK(dir.nEntries() == 1);
+    }
+
+    SECTION("an empty file can be published") {
+        publish(fn.string(), nullptr, 0);
+        CHECK(fs::file_size(fn) == 0);
+    }
+}
+
+TEST_CASE("publish throws when the file can not be created", "[publish]") {
+    ScopedDir dir;
+    const fs::path fn(dir.path / "missing" / "out.bin");
+    CHECK_THROWS_AS(publish(fn.string(), "xy", 2), MyException);
+    CHECK_FALSE(fs::exists(fn));
+    CHECK(dir.nEntries() == 0);
+}
+
+TEST_CASE("publish throws, removing its temporary, when the rename fails", "[publish]") {
+    ScopedDir dir;
+    const fs::path fn(dir.path / "out.bin");
+    fs::create_directories(fn / "occupied"); // A non-empty directory in the way
+    CHECK_THROWS_AS(publish(fn.string(), "xy", 2), MyException);
+    CHECK(fs::is_directory(fn));
+    CHECK(dir.nEntries() == 1);
+}
+
+TEST_CASE("publish streams what its writer writes", "[publish]") {
+    ScopedDir dir;
+    const fs::path fn(dir.path / "out.bin");
+
+    publish(fn.string(), [](std::ostream& os) {
+        for (int i(0); i < 3; ++i) os << "line " << i << '\n';
+    });
+    CHECK(slurp(fn) == "line 0\nline 1\nline 2\n");
+    CHECK(dir.nEntries() == 1);
+}
+
+TEST_CASE("publish removes its temporary when the writer throws", "[publish]") {
+    ScopedDir dir;
+    const fs::path fn(dir.path / "out.bin");
+
+    CHECK_THROWS_AS(publish(fn.string(), [](std::ostream& os) {
+        os << "partial";
+        throw MyException("writer failed");
+    }), MyException);
+    CHECK_FALSE(fs::exists(fn));
+    CHECK(dir.nEntries() == 0);
+}
@@ -0,0 +1,184 @@
+// Unit tests for SensorCache, the binary sensor cache, and for Sensors
+// reading it ahead of the text cache.
+
+#include <catch2/catch_test_macros.hpp>
+#include "SensorCache.H"
+#include "Sensors.H"
+#include "Header.H"
+#include "MyException.H"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string tempPath(const std::string& stem) {
+    std::mt19937 rng{std::random_device{}()};
+    return (fs::temp_directory_path() /
+            ("dbd2netcdf_test_" + stem + "_" + std::to_string(rng()))).string();
+}
+
+struct ScopedDir {
+    std::string path;
+    explicit ScopedDir(const std::string& stem) : path(tempPath(stem)) {
+        fs::create_directories(path);
+    }
+    ~ScopedDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+    ScopedDir(const ScopedDir&) = delete;
+    ScopedDir& operator=(const ScopedDir&) = delete;
+};
+
+void writeFile(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream os(path, std::ios::binary);
+    os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::vector<Sensor> makeSensors(const size_t n) {
+    std::vector<Sensor> sensors;
+    for (size_t i(0); i < n; ++i) {
+        std::ostringstream oss;
+        oss << "s: T " << i << " " << i << " " << (i % 2 ? 4 : 8)
+            << " sensor_" << i << " " << (i % 3 ? "m" : "nodim");
+        sensors.emplace_back(oss.str());
+    }
+    return sensors;
+}
+
+// A factored header, so Sensors comes from the cache alone
+Header makeHeader(const std::string& crc) {
+    std::istringstream is("num_ascii_tags: 3\nsensor_list_factored: 1\nsensor_list_crc: " + crc + "\n");
+    return Header(is, "cache.sbd");
+}
+} // namespace
+
+TEST_CASE("SensorCache round trips a sensor list", "[sensorcache]") {
+    ScopedDir dir("bcc");
+    const std::string fn((fs::path(dir.path) / "abcd.bcc").string());
+    const std::vector<Sensor> sensors(makeSensors(300));
+    writeFile(fn, SensorCache::encode("abcd", sensors));
+
+    const SensorCache cache(fn);
+    REQUIRE(cache.qOpen());
+    CHECK(cache.crc() == "abcd");
+    REQUIRE(cache.size() == sensors.size());
+    for (size_t i(0); i < sensors.size(); ++i) {
+        const Sensor got(cache.sensor(i));
+        CHECK(got.name() == sensors[i].name());
+        CHECK(got.units() == sensors[i].units());
+        CHECK(got.size() == sensors[i].size());
+        CHECK(got.naturalIndex() == sensors[i].naturalIndex());
+        CHECK(got.index() == sensors[i].index());
+        CHECK(got.qAvailable());
+        CHECK(cache.find(sensors[i].name()) == i);
+    }
+    CHECK(cache.find("sensor_300") == SensorCache::npos);
+    CHECK(cache.find("") == SensorCache::npos);
+
+    // Units are interned: "m" and "nodim" are stored once each
+    size_t names(0);
+    for (const Sensor& sensor : sensors) names += sensor.name().size();
+    CHECK(fs::file_size(fn) < SensorCache::HEADER_SIZE + sensors.size() * SensorCache::RECORD_SIZE +
+                              4 * 1024 + 4 + names + 100);
+}
+
+TEST_CASE("SensorCache of an empty sensor list", "[sensorcache]") {
+    ScopedDir dir("bcc_empty");
+    const std::string fn((fs::path(dir.path) / "beef.bcc").string());
+    writeFile(fn, SensorCache::encode("beef", std::vector<Sensor>()));
+
+    const SensorCache cache(fn);
+    REQUIRE(cache.qOpen());
+    CHECK(cache.size() == 0);
+    CHECK(cache.find("m_depth") == SensorCache::npos);
+}
+
+TEST_CASE("SensorCache is not open for anything but its own version", "[sensorcache]") {
+    ScopedDir dir("bcc_other");
+    const std::string fn((fs::path(dir.path) / "other.bcc").string());
+
+    CHECK_FALSE(SensorCache(fn).qOpen()); // Missing
+
+    writeFile(fn, {'s', ':', ' ', 'T', '\n'}); // A text cache
+    CHECK_FALSE(SensorCache(fn).qOpen());
+
+    std::vector<char> bytes(SensorCache::encode("abcd", makeSensors(3)));
+    bytes[8] = static_cast<char>(SensorCache::FORMAT_VERSION + 1);
+    writeFile(fn, bytes);
+    CHECK_FALSE(SensorCache(fn).qOpen());
+}
+
+TEST_CASE("SensorCache rejects an inconsistent file", "[sensorcache]") {
+    ScopedDir dir("bcc_corrupt");
+    const std::string fn((fs::path(dir.path) / "bad.bcc").string());
+    const std::vector<char> good(SensorCache::encode("abcd", makeSensors(10)));
+
+    SECTION("Truncated") {
+        writeFile(fn, std::vector<char>(good.begin(), good.end() - 1));
+        CHECK_THROWS_AS(SensorCache(fn), MyException);
+    }
+
+    SECTION("A name outside the string table") {
+        std::vector<char> bytes(good);
+        bytes[SensorCache::HEADER_SIZE + 3] = '\x7f'; // First record's name offset
+        writeFile(fn, bytes);
+        CHECK_THROWS_AS(SensorCache(fn), MyException);
+    }
+
+    SECTION("A hash slot past the last sensor") {
+        std::vector<char> bytes(good);
+        bytes[SensorCache::HEADER_SIZE + 10 * SensorCache::RECORD_SIZE] = 11;
+        writeFile(fn, bytes);
+        CHECK_THROWS_AS(SensorCache(fn), MyException);
+    }
+}
+
+TEST_CASE("Sensors writes and prefers the binary cache", "[sensorcache][sensors]") {
+    ScopedDir dir("bcc_sensors");
+    const Header hdr(makeHeader("ABCD"));
+
+    Sensors original;
+    for (const Sensor& sensor : makeSensors(5)) original.insert(sensor);
+    // dump() takes the CRC from the sensors, so give them one through load()
+    {
+        std::ofstream os((fs::path(dir.path) / "abcd.cac").string());
+        for (const Sensor& sensor : makeSensors(5)) sensor.dump(os);
+    }
+    Sensors fromText;
+    REQUIRE(fromText.load(dir.path, hdr));
+    CHECK(fromText.size() == 5);
+    CHECK_FALSE(fs::exists(fromText.mkBinaryFilename(dir.path)));
+
+    REQUIRE(fromText.dump(dir.path));
+    const std::string bcc(fromText.mkBinaryFilename(dir.path));
+    CHECK(fs::path(bcc).filename().string() == "abcd.bcc");
+    REQUIRE(fs::exists(bcc));
+
+    SECTION("The binary cache is read first") {
+        { // A text cache that no longer parses is not read
+            std::ofstream os((fs::path(dir.path) / "abcd.cac").string());
+            os << "this is not a sensor line\n";
+        }
+        Sensors fromBinary;
+        REQUIRE(fromBinary.load(dir.path, hdr));
+        REQUIRE(fromBinary.size() == original.size());
+        for (size_t i(0); i < original.size(); ++i) {
+            CHECK(fromBinary[i].name() == original[i].name());
+            CHECK(fromBinary[i].units() == original[i].units());
+            CHECK(fromBinary[i].size() == original[i].size());
+        }
+        CHECK(fromBinary.nToStore() == original.size());
+    }
+
+    SECTION("A binary cache for another CRC is corrupt") {
+        fs::rename(bcc, (fs::path(dir.path) / "beef.bcc"));
+        Sensors other;
+        CHECK_THROWS_AS(other.load(dir.path, makeHeader("beef")), MyException);
+    }
+}
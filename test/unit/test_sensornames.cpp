@@ -0,0 +1,101 @@
+// Unit tests for SensorNames, the process-wide table of interned sensor
+// names and units, and for NameSet, the bitset filters built over it.
+
+#include <catch2/catch_test_macros.hpp>
+#include "SensorNames.H"
+#include "Sensor.H"
+#include "Sensors.H"
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SensorNames gives each distinct string one id", "[sensornames]") {
+    const SensorNames::tID depth(SensorNames::intern("names_test_m_depth"));
+    const SensorNames::tID roll(SensorNames::intern("names_test_m_roll"));
+
+    CHECK(depth != roll);
+    CHECK(SensorNames::intern("names_test_m_depth") == depth);
+    CHECK(SensorNames::find("names_test_m_roll") == roll);
+    CHECK(SensorNames::find("names_test_never_interned") == SensorNames::npos);
+    CHECK(SensorNames::str(depth) == "names_test_m_depth");
+    CHECK(SensorNames::size() > roll);
+
+    SensorNames::tID id;
+    const std::string& str(SensorNames::intern("names_test_m_depth", id));
+    CHECK(id == depth);
+    CHECK(&str == &SensorNames::str(depth));
+}
+
+TEST_CASE("Sensors share their interned names", "[sensornames][sensor]") {
+    const Sensor a("s: T 0 0 4 names_test_shared m");
+    const Sensor b("s: T 1 1 8 names_test_shared m");
+    const Sensor c("names_test_shared", "m", 2, 2, 2, true);
+
+    CHECK(a.nameID() == b.nameID());
+    CHECK(c.nameID() == a.nameID());
+    CHECK(&a.name() == &b.name());
+    CHECK(&a.units() == &c.units());
+    CHECK(a.name() == "names_test_shared");
+    CHECK(SensorNames::str(a.nameID()) == a.name());
+}
+
+TEST_CASE("NameSet holds ids as a bitset", "[sensornames]") {
+    NameSet set;
+    CHECK_FALSE(set.contains(0));
+    CHECK_FALSE(set.contains(1000));
+
+    set.insert(3);
+    set.insert(64);
+    set.insert(1000);
+    CHECK(set.contains(3));
+    CHECK(set.contains(64));
+    CHECK(set.contains(1000));
+    CHECK_FALSE(set.contains(4));
+    CHECK_FALSE(set.contains(63));
+    CHECK_FALSE(set.contains(1001));
+    CHECK_FALSE(set.contains(SensorNames::npos));
+}
+
+TEST_CASE("NameSet from names matches sensors read afterwards", "[sensornames][sensors]") {
+    const NameSet keep(Sensors::tNames{"names_test_later_a", "names_test_later_c"});
+
+    Sensors sensors;
+    sensors.insert(Sensor("s: T 0 0 4 names_test_later_a m"));
+    sensors.insert(Sensor("s: T 1 1 4 names_test_later_b m"));
+    sensors.insert(Sensor("s: T 2 2 4 names_test_later_c m"));
+    sensors.qKeep(keep);
+
+    CHECK(sensors.nToStore() == 2);
+    CHECK(sensors[0].qKeep());
+    CHECK_FALSE(sensors[1].qKeep());
+    CHECK(sensors[2].qKeep());
+}
+
+TEST_CASE("SensorNames interns consistently across threads", "[sensornames]") {
+    const size_t nThreads(4);
+    const size_t nNames(512); // Any odd stride visits every name
+    std::vector<std::vector<SensorNames::tID>> ids(nThreads);
+    std::vector<std::thread> threads;
+
+    for (size_t t(0); t < nThreads; ++t) {
+        threads.emplace_back([t, nNames, &ids] {
+            for (size_t i(0); i < nNames; ++i) { // Each thread in its own order
+                const size_t k((i * (2 * t + 1)) % nNames);
+                ids[t].push_back(SensorNames::intern("names_test_thread_" + std::to_string(k)));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (size_t i(0); i < nNames; ++i) {
+        const SensorNames::tID id(SensorNames::find("names_test_thread_" + std::to_string(i)));
+        REQUIRE(id != SensorNames::npos);
+        CHECK(SensorNames::str(id) == "names_test_thread_" + std::to_string(i));
+    }
+    for (size_t t(0); t < nThreads; ++t) {
+        for (size_t i(0); i < nNames; ++i) {
+            const size_t k((i * (2 * t + 1)) % nNames);
+            CHECK(ids[t][i] == SensorNames::find("names_test_thread_" + std::to_string(k)));
+        }
+    }
+}
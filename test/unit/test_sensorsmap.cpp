@@ -7,9 +7,13 @@
 #include "Sensors.H"
 #include "Header.H"
 #include "MyException.H"
+#include <filesystem>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 namespace {
 // Build a minimal DBD ASCII header with the four fields SensorsMap needs:
@@ -22,6 +26,37 @@ std::string makeHeader(const std::string& crc, int nSensors) {
         << "sensor_list_crc: " << crc << "\n";
     return oss.str();
 }
+
+// nSensors sensor lines, the first shared by every CRC group
+std::string makeSensorLines(int group, int nSensors) {
+    std::ostringstream oss;
+    for (int i = 0; i < nSensors; ++i) {
+        oss << "s: T " << i << " " << i << " 4 "
+            << (i ? "group_" + std::to_string(group) + "_" + std::to_string(i) : std::string("m_depth"))
+            << " m\n";
+    }
+    return oss.str();
+}
+
+std::string crcOf(int group) {
+    return "C" + std::to_string(1000 + group);
+}
+
+struct ScopedCacheDir {
+    std::string path;
+    ScopedCacheDir() {
+        std::mt19937 rng{std::random_device{}()};
+        path = (std::filesystem::temp_directory_path() /
+                ("dbd2netcdf_test_smap_" + std::to_string(rng()))).string();
+        std::filesystem::create_directories(path);
+    }
+    ~ScopedCacheDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    ScopedCacheDir(const ScopedCacheDir&) = delete;
+    ScopedCacheDir& operator=(const ScopedCacheDir&) = delete;
+};
 } // namespace
 
 TEST_CASE("SensorsMap rejects same sensor at different sizes across CRC groups",
@@ -103,3 +138,89 @@ TEST_CASE("SensorsMap with a single CRC group assigns sequential indices",
     CHECK(all.size() == 3);
     CHECK(all.nToStore() == 3);
 }
+
+TEST_CASE("SensorsMap reads each new CRC once across threads",
+          "[sensorsmap][threads]") {
+    ScopedCacheDir dir;
+    const int nThreads = 8;
+    const int nGroups = 40;
+    const int nSensors = 20;
+
+    // Every thread inserts every group, each in its own order, then finds
+    // them all; each group must end up as a single Sensors
+    SensorsMap map(dir.path);
+    std::vector<std::vector<const Sensors *>> found(nThreads);
+    std::vector<int> consumed(nThreads, 0); // Catch2 assertions are not thread safe
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < nGroups; ++i) {
+                const int group = (i * (2 * t + 1) + t) % nGroups;
+                std::istringstream hs(makeHeader(crcOf(group), nSensors));
+                const Header h(hs, "thread");
+                std::istringstream ss(makeSensorLines(group, nSensors));
+                map.insert(ss, h, true);
+                consumed[t] += ss.tellg() == static_cast<std::streamoff>(ss.str().size());
+            }
+            for (int group = 0; group < nGroups; ++group) {
+                std::istringstream hs(makeHeader(crcOf(group), nSensors));
+                const Header h(hs, "thread");
+                found[t].push_back(&map.find(h));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < nThreads; ++t) {
+        CHECK(consumed[t] == nGroups); // Every insert read past the sensor lines
+        CHECK(found[t] == found[0]);
+    }
+    for (int group = 0; group < nGroups; ++group) {
+        CHECK(found[0][group]->size() == static_cast<size_t>(nSensors));
+    }
+
+    // One text and one binary cache per group, and no stray temporaries
+    size_t nFiles = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir.path)) {
+        const std::string ext(entry.path().extension().string());
+        CHECK((ext == ".cac" || ext == ".bcc"));
+        ++nFiles;
+    }
+    CHECK(nFiles == 2 * nGroups);
+
+    REQUIRE_NOTHROW(map.setUpForData());
+    CHECK(map.allSensors().size() == static_cast<size_t>(1 + nGroups * (nSensors - 1)));
+}
+
+TEST_CASE("SensorsMap loads a cached CRC once across threads",
+          "[sensorsmap][threads]") {
+    ScopedCacheDir dir;
+    { // Populate the cache
+        SensorsMap writer(dir.path);
+        std::istringstream hs(makeHeader(crcOf(7), 5));
+        const Header h(hs, "writer");
+        std::istringstream ss(makeSensorLines(7, 5));
+        writer.insert(ss, h, false);
+    }
+
+    std::ostringstream factored;
+    factored << "num_ascii_tags: 3\nsensor_list_factored: 1\nsensor_list_crc: " << crcOf(7) << "\n";
+
+    SensorsMap map(dir.path);
+    const int nThreads = 8;
+    std::vector<const Sensors *> found(nThreads, nullptr);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::istringstream hs(factored.str());
+            const Header h(hs, "reader");
+            found[t] = &map.find(h);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < nThreads; ++t) {
+        CHECK(found[t] == found[0]);
+    }
+    CHECK(found[0]->size() == 5);
+}
@@ -0,0 +1,150 @@
+// Unit tests for StateBitmap, the expansion of a record's 2-bit state codes
+// into the list of sensors that repeat or carry a new value.
+
+#include <catch2/catch_test_macros.hpp>
+#include "StateBitmap.H"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+// The scalar walk Data::load used before StateBitmap, as the reference
+std::vector<StateBitmap::tEvent> reference(const std::vector<uint8_t>& bits,
+                                           const size_t nSensors,
+                                           const std::vector<uint8_t>& widths,
+                                           size_t& bodySize) {
+    std::vector<StateBitmap::tEvent> events;
+    bodySize = 0;
+    for (size_t i(0); i < nSensors; ++i) {
+        const unsigned int code((bits[i >> 2] >> (6 - ((i & 0x3) << 1))) & 0x03);
+        if ((code == 1) || (code == 2)) {
+            events.push_back(static_cast<StateBitmap::tEvent>((i << 2) | code));
+            if (code == 2) bodySize += widths[i];
+        }
+    }
+    return events;
+}
+} // namespace
+
+TEST_CASE("StateBitmap decodes the codes of one byte", "[statebitmap]") {
+    // Sensor 0 new, 1 absent, 2 repeat, 3 unused code 3
+    const uint8_t bits[1] = {0x9b}; // 10 01 10 11
+    const uint8_t widths[4] = {4, 2, 8, 1};
+    StateBitmap states(4, widths);
+    states.expand(bits);
+
+    REQUIRE(states.size() == 3);
+    CHECK(StateBitmap::sensor(states.events()[0]) == 0);
+    CHECK(StateBitmap::code(states.events()[0]) == 2);
+    CHECK(StateBitmap::sensor(states.events()[1]) == 1);
+    CHECK(StateBitmap::code(states.events()[1]) == 1);
+    CHECK(StateBitmap::sensor(states.events()[2]) == 2);
+    CHECK(StateBitmap::code(states.events()[2]) == 2);
+    CHECK(states.bodySize() == 4 + 8);
+}
+
+TEST_CASE("StateBitmap ignores the padding pairs of the last byte", "[statebitmap]") {
+    const uint8_t bits[2] = {0x00, 0xaa}; // Sensor 4 new; 5..7 are padding
+    const uint8_t widths[5] = {1, 1, 1, 1, 2};
+    StateBitmap states(5, widths);
+    REQUIRE(states.nBytes() == 2);
+    states.expand(bits);
+
+    REQUIRE(states.size() == 1);
+    CHECK(StateBitmap::sensor(states.events()[0]) == 4);
+    CHECK(states.bodySize() == 2);
+}
+
+TEST_CASE("StateBitmap matches a scalar walk of random bitmaps", "[statebitmap]") {
+    std::mt19937 rng(20261017);
+    for (const size_t nSensors : {1, 3, 4, 31, 32, 33, 64, 127, 1906}) {
+        std::vector<uint8_t> widths(nSensors);
+        for (auto& w : widths) w = static_cast<uint8_t>(1u << (rng() % 4));
+
+        StateBitmap states(nSensors, widths.data());
+        std::vector<uint8_t> bits(states.nBytes());
+        for (int trial(0); trial < 50; ++trial) {
+            // Mostly idle sensors with occasional bursts, like a science file
+            for (auto& b : bits) b = (rng() % 8) ? 0 : static_cast<uint8_t>(rng());
+            if (trial == 0) std::fill(bits.begin(), bits.end(), 0);
+            if (trial == 1) std::fill(bits.begin(), bits.end(), 0xff);
+
+            size_t bodySize;
+            const std::vector<StateBitmap::tEvent> expected(
+                reference(bits, nSensors, widths, bodySize));
+
+            states.expand(bits.data());
+            REQUIRE(states.size() == expected.size());
+            CHECK(std::vector<StateBitmap::tEvent>(
+                      states.events(), states.events() + states.size()) == expected);
+            CHECK(states.bodySize() == bodySize);
+        }
+    }
+}
+
+TEST_CASE("StateBitmap reports only visited sensors, with their value offsets", "[statebitmap]") {
+    std::mt19937 rng(20261018);
+    for (const size_t nSensors : {1, 5, 33, 1906}) {
+        std::vector<uint8_t> widths(nSensors);
+        std::vector<uint8_t> visit(nSensors);
+        for (size_t i(0); i < nSensors; ++i) {
+            widths[i] = static_cast<uint8_t>(1u << (rng() % 4));
+            visit[i] = (i > 0) && ((rng() % 5) == 0); // Never all of them
+        }
+
+        StateBitmap states(nSensors, widths.data(), visit.data());
+        REQUIRE(states.offsets() != nullptr);
+        CHECK(StateBitmap(nSensors, widths.data()).offsets() == nullptr); // In order
+        std::vector<uint8_t> bits(states.nBytes());
+        for (int trial(0); trial < 50; ++trial) {
+            for (auto& b : bits) b = (rng() % 4) ? 0 : static_cast<uint8_t>(rng());
+            if (trial == 0) std::fill(bits.begin(), bits.end(), 0xaa); // All new
+
+            std::vector<StateBitmap::tEvent> events;
+            std::vector<uint32_t> offsets;
+            uint32_t bodySize(0);
+            for (size_t i(0); i < nSensors; ++i) {
+                const unsigned int code((bits[i >> 2] >> (6 - ((i & 0x3) << 1))) & 0x03);
+                if (visit[i] && ((code == 1) || (code == 2))) {
+                    events.push_back(static_cast<StateBitmap::tEvent>((i << 2) | code));
+                    offsets.push_back(bodySize);
+                }
+                if (code == 2) bodySize += widths[i];
+            }
+
+            states.expand(bits.data());
+            REQUIRE(states.size() == events.size());
+            CHECK(std::vector<StateBitmap::tEvent>(
+                      states.events(), states.events() + states.size()) == events);
+            CHECK(states.bodySize() == bodySize);
+            for (size_t k(0); k < events.size(); ++k) {
+                if (StateBitmap::code(events[k]) == 2) CHECK(states.offsets()[k] == offsets[k]);
+            }
+        }
+    }
+}
+
+TEST_CASE("StateBitmap reports whether a criteria sensor is active", "[statebitmap]") {
+    const uint8_t widths[6] = {1, 2, 4, 8, 1, 2};
+    const uint8_t select[6] = {0, 0, 0, 0, 0, 1};
+    StateBitmap states(6, widths, nullptr, select);
+
+    const uint8_t others[2] = {0x9a, 0x80}; // Sensors 0..4 active, 5 not
+    states.expand(others);
+    CHECK_FALSE(states.qSelected());
+    CHECK(states.size() == 5);
+
+    const uint8_t repeat[2] = {0x00, 0x10}; // Sensor 5 repeats
+    states.expand(repeat);
+    CHECK(states.qSelected());
+    CHECK(states.bodySize() == 0);
+
+    const uint8_t unused[2] = {0x00, 0x30}; // Code 3 is not active
+    states.expand(unused);
+    CHECK_FALSE(states.qSelected());
+
+    StateBitmap all(6, widths);
+    all.expand(others);
+    CHECK(all.qSelected());
+}